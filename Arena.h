@@ -0,0 +1,328 @@
+// ----------------------
+// projects/graph/Arena.h
+// Copyright (C) 2012
+// Glenn P. Downing
+// ----------------------
+
+#ifndef Arena_h
+#define Arena_h
+
+// --------
+// includes
+// --------
+
+#include <cstddef> // ptrdiff_t, size_t
+#include <new>     // bad_alloc, operator new, operator delete
+#include <vector>  // vector
+
+// -----
+// arena
+// -----
+
+/**
+ * a slab allocator for many small, short lived buffers, like the rows of
+ *     a Graph's adjacency
+ * requests are rounded up to a power of two and carved off large blocks,
+ *     a freed buffer goes on the free list of its size and is handed out
+ *     again before any new space, so a growing vector reuses the buffers
+ *     it leaves behind
+ * nothing is returned to the heap until the arena is destroyed, then every
+ *     block goes at once
+ * buffers are aligned to at least a pointer, so T must not need more
+ * like the containers it serves, an arena is not safe to share across
+ *     threads
+ */
+class arena {
+    private:
+        // ----
+        // data
+        // ----
+
+	//a freed buffer holds the next freed buffer of its size
+	struct free_buffer {
+	    free_buffer* next;};
+
+	//every block ever taken from the heap
+	std::vector<char*> blocks;
+	//the unused tail of the newest small block
+	char* next;
+	char* end;
+	//free_lists[k] holds freed buffers of 2^k bytes
+	free_buffer* free_lists[sizeof(std::size_t) * 8];
+	std::size_t block_size;
+	std::size_t reserved;
+	//the arena_allocators sharing the arena
+	std::size_t users;
+
+	template <typename T>
+	friend class arena_allocator;
+
+	// ----------
+	// size_class
+	// ----------
+
+	/**
+	 * helper method that finds the smallest k with 2^k >= bytes,
+	 *     never less than 3, so every buffer can hold a free_buffer
+	 */
+	static unsigned size_class (std::size_t bytes) {
+	    unsigned k = 3;
+	    while((std::size_t(1) << k) < bytes)
+		++k;
+	    return k;}
+
+	// -----
+	// carve
+	// -----
+
+	/**
+	 * helper method that takes fresh space for a buffer of 2^k bytes,
+	 *     from the newest block or from a new one
+	 */
+	void* carve (unsigned k) {
+	    const std::size_t bytes = std::size_t(1) << k;
+	    if(bytes > block_size / 4) {
+		// a large buffer gets a block of its own
+		blocks.push_back(static_cast<char*>(::operator new(bytes)));
+		reserved += bytes;
+		return blocks.back();}
+	    if(std::size_t(end - next) < bytes) {
+		blocks.push_back(static_cast<char*>(::operator new(block_size)));
+		reserved += block_size;
+		next = blocks.back();
+		end  = next + block_size;}
+	    void* p = next;
+	    next += bytes;
+	    return p;}
+
+	// an arena owns its blocks, so it is not copyable
+	arena (const arena&);
+	arena& operator = (const arena&);
+
+    public:
+        // ------------
+        // constructors
+        // ------------
+
+        /**
+	 * an empty arena, no block is taken until the first allocate
+	 * @param block_size the bytes taken from the heap at a time
+         */
+        explicit arena (std::size_t block_size = 64 * 1024) :
+		next(0),
+		end(0),
+		block_size(block_size),
+		reserved(0),
+		users(0) {
+	    for(unsigned k = 0; k < sizeof(free_lists) / sizeof(free_lists[0]); ++k)
+		free_lists[k] = 0;}
+
+        /**
+	 * releases every block, whether or not its buffers were deallocated
+         */
+        ~arena () {
+	    for(unsigned int i = 0; i < blocks.size(); ++i)
+		::operator delete(blocks[i]);}
+
+        // --------
+        // allocate
+        // --------
+
+        /**
+	 * @param bytes the size of the buffer
+	 * @return a buffer of at least bytes, reused if one of its size is free
+	 * @throws std::bad_alloc if the heap is exhausted
+         */
+        void* allocate (std::size_t bytes) {
+	    const unsigned k = size_class(bytes);
+	    if(free_buffer* p = free_lists[k]) {
+		free_lists[k] = p->next;
+		return p;}
+	    return carve(k);}
+
+        // ----------
+        // deallocate
+        // ----------
+
+        /**
+	 * puts a buffer on the free list of its size, O(1), nothing is freed
+	 * @param p a buffer from allocate
+	 * @param bytes the size it was allocated with
+         */
+        void deallocate (void* p, std::size_t bytes) {
+	    const unsigned k = size_class(bytes);
+	    free_buffer* b = static_cast<free_buffer*>(p);
+	    b->next = free_lists[k];
+	    free_lists[k] = b;}
+
+        // --------------
+        // bytes_reserved
+        // --------------
+
+        /**
+	 * @return the bytes taken from the heap so far
+         */
+        std::size_t bytes_reserved () const {
+	    return reserved;}
+
+        // ---------------
+        // bytes_per_block
+        // ---------------
+
+        /**
+	 * @return the bytes taken from the heap at a time
+         */
+        std::size_t bytes_per_block () const {
+	    return block_size;}};
+
+// ---------------
+// arena_allocator
+// ---------------
+
+/**
+ * a standard allocator over a shared arena
+ * a default constructed allocator makes a new arena, copies share it, and
+ *     the arena is released with the last copy, so a container and every
+ *     container built from its allocator are torn down together
+ * the copies are counted without atomics, so every container sharing an
+ *     arena must stay on one thread
+ * a copied Graph does not share, see copy_allocator
+ */
+template <typename T>
+class arena_allocator {
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef T                 value_type;
+        typedef T*                pointer;
+        typedef const T*          const_pointer;
+        typedef T&                reference;
+        typedef const T&          const_reference;
+        typedef std::size_t       size_type;
+        typedef std::ptrdiff_t    difference_type;
+
+        template <typename U>
+        struct rebind {
+            typedef arena_allocator<U> other;};
+
+    private:
+        // ----
+        // data
+        // ----
+
+	arena* a;
+
+	template <typename U>
+	friend class arena_allocator;
+
+    public:
+        // ------------
+        // constructors
+        // ------------
+
+        /**
+	 * an allocator over a new arena
+	 * @param block_size the bytes the arena takes from the heap at a time
+         */
+        explicit arena_allocator (std::size_t block_size = 64 * 1024) :
+		a(new arena(block_size)) {
+	    ++a->users;}
+
+        /**
+	 * the same arena
+         */
+        arena_allocator (const arena_allocator& that) :
+		a(that.a) {
+	    ++a->users;}
+
+        /**
+	 * the same arena, for another value_type
+         */
+        template <typename U>
+        arena_allocator (const arena_allocator<U>& that) :
+		a(that.a) {
+	    ++a->users;}
+
+        /**
+	 * the last copy releases the arena
+         */
+        ~arena_allocator () {
+	    if(--a->users == 0)
+		delete a;}
+
+        /**
+	 * share the arena of that instead
+         */
+        arena_allocator& operator = (const arena_allocator& that) {
+	    ++that.a->users;
+	    if(--a->users == 0)
+		delete a;
+	    a = that.a;
+	    return *this;}
+
+        // -----------
+        // allocations
+        // -----------
+
+        pointer allocate (size_type n, const void* = 0) {
+	    return static_cast<pointer>(a->allocate(n * sizeof(T)));}
+
+        void deallocate (pointer p, size_type n) {
+	    a->deallocate(p, n * sizeof(T));}
+
+        size_type max_size () const {
+	    return size_type(-1) / sizeof(T);}
+
+        void construct (pointer p, const T& v) {
+	    new (p) T(v);}
+
+        void destroy (pointer p) {
+	    p->~T();}
+
+        pointer address (reference r) const {
+	    return &r;}
+
+        const_pointer address (const_reference r) const {
+	    return &r;}
+
+        // ---------
+        // get_arena
+        // ---------
+
+        /**
+	 * @return the shared arena
+         */
+        const arena& get_arena () const {
+	    return *a;}
+
+        // -----------
+        // comparisons
+        // -----------
+
+	// two allocators are equal if either can free what the other allocates
+        template <typename U>
+        bool operator == (const arena_allocator<U>& that) const {
+	    return a == that.a;}
+
+        template <typename U>
+        bool operator != (const arena_allocator<U>& that) const {
+	    return a != that.a;}};
+
+// --------------
+// copy_allocator
+// --------------
+
+/**
+ * the allocator of a copied Graph, a new arena with the same block size
+ *     so the copy is as independent as one on the heap, and can go to
+ *     another thread
+ * @param a the allocator of the original
+ * @return an allocator over a new arena
+ */
+template <typename T>
+arena_allocator<T> copy_allocator (const arena_allocator<T>& a) {
+    return arena_allocator<T>(a.get_arena().bytes_per_block());}
+
+#endif // Arena_h
@@ -0,0 +1,257 @@
+// -----------------------------
+// projects/graph/BenchGraph.c++
+// Copyright (C) 2012
+// Glenn P. Downing
+// -----------------------------
+
+/*
+To run the benchmark:
+    % g++ -pedantic -O2 -DNDEBUG -I/public/linux/include/boost-1_44 -Wall BenchGraph.c++ -o BenchGraph.app
+    % BenchGraph.app [max_edges] > BenchGraph.csv
+
+max_edges defaults to 1000000, sizes run from 1000 up to it by powers of 10.
+arena_graph is Graph with its rows in an arena, see Arena.h.
+Each (graph, shape, size) case runs in its own child process, so peak_rss_kb
+is the peak resident size of that case alone. The bulk constructor, op
+add_edges, is a case of its own, so it does not raise the other ops' peak. One CSV row is written per
+operation:
+    graph,shape,vertices,edges,op,count,seconds,per_second,peak_rss_kb
+has_cycle and topological_sort stop at the first cycle, so they are only
+timed on the acyclic shapes, chain and layered, where they visit every edge.
+*/
+
+// --------
+// includes
+// --------
+
+#include <cmath>    // sqrt
+#include <cstdio>   // fflush, fprintf, printf
+#include <cstdlib>  // atol, exit, rand, srand
+#include <ctime>    // clock, clock_t, CLOCKS_PER_SEC
+#include <iterator> // back_inserter
+#include <utility>  // make_pair, pair
+#include <vector>   // vector
+
+#include <sys/resource.h> // getrusage
+#include <sys/wait.h>     // waitpid
+#include <unistd.h>       // fork
+
+#include "boost/graph/adjacency_list.hpp" // adjacency_list
+
+#include "Arena.h"
+#include "Graph.h"
+
+typedef std::vector< std::pair<int, int> > edge_list;
+
+typedef basic_graph<int, no_edge_property, arena_allocator<int> > arena_graph;
+
+// ------
+// shapes
+// ------
+
+/**
+ * random edges, about 4 per vertex, with duplicates and cycles
+ */
+int sparse (long num_e, edge_list& input) {
+    int num_v = num_e / 4;
+    for(long i = 0; i < num_e; ++i)
+	input.push_back(std::make_pair(std::rand() % num_v, std::rand() % num_v));
+    return num_v;}
+
+/**
+ * random edges among few vertices, about half of all pairs
+ */
+int dense (long num_e, edge_list& input) {
+    int num_v = std::sqrt(2.0 * num_e) + 1;
+    for(long i = 0; i < num_e; ++i)
+	input.push_back(std::make_pair(std::rand() % num_v, std::rand() % num_v));
+    return num_v;}
+
+/**
+ * one long path, 0 -> 1 -> ... -> num_e
+ */
+int chain (long num_e, edge_list& input) {
+    for(long i = 0; i < num_e; ++i)
+	input.push_back(std::make_pair(i, i + 1));
+    return num_e + 1;}
+
+/**
+ * a DAG of square-ish layers, each vertex has 4 edges into the next layer
+ */
+int layered (long num_e, edge_list& input) {
+    int num_v = num_e / 4;
+    int width = std::sqrt(double(num_v)) + 1;
+    for(long i = 0; i < num_e; ++i) {
+	int v = std::rand() % (num_v - width);
+	input.push_back(std::make_pair(v, (v / width + 1) * width + std::rand() % width));}
+    return num_v + width;}
+
+/**
+ * disjoint copies of the 8 vertex, 11 edge graph of TestGraph, each with
+ *     the cycle 3 -> 5 -> 3, so millions of vertices of degree one or two
+ */
+int tiled (long num_e, edge_list& input) {
+    const int fixture[11][2] = {{0, 1}, {0, 2}, {0, 4}, {1, 3}, {1, 4}, {2, 3},
+                                {3, 4}, {3, 5}, {5, 3}, {5, 7}, {6, 7}};
+    long copies = num_e / 11;
+    for(long c = 0; c < copies; ++c)
+	for(int i = 0; i < 11; ++i)
+	    input.push_back(std::make_pair(8 * c + fixture[i][0], 8 * c + fixture[i][1]));
+    return 8 * copies;}
+
+// -----
+// input
+// -----
+
+/**
+ * makes the same edges for every graph type given a shape and size
+ * @return the number of vertices
+ */
+int input (int (*make) (long, edge_list&), long num_e, edge_list& edges) {
+    std::srand(num_e);
+    edges.reserve(num_e);
+    return make(num_e, edges);}
+
+// ------
+// report
+// ------
+
+/**
+ * writes one CSV row
+ */
+void report (const char* graph, const char* shape, int num_v, long num_e,
+	const char* op, long count, double seconds) {
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    std::printf("%s,%s,%d,%ld,%s,%ld,%.6f,%.0f,%ld\n", graph, shape, num_v, num_e,
+	op, count, seconds, seconds > 0 ? count / seconds : 0.0, usage.ru_maxrss);}
+
+// -----
+// bench
+// -----
+
+/**
+ * times every operation on one graph type, shape and size
+ * the algorithms are skipped unless the shape is acyclic
+ */
+template <typename G>
+void bench (const char* graph, const char* shape, int (*make) (long, edge_list&), bool acyclic, long num_e) {
+    typedef typename G::vertex_descriptor vertex_descriptor;
+    typedef typename G::adjacency_iterator adjacency_iterator;
+
+    edge_list edges;
+    int num_v = input(make, num_e, edges);
+
+    // add_edge
+    G* built = new G;
+    G& g = *built;
+    for(int i = 0; i < num_v; ++i)
+	add_vertex(g);
+    std::clock_t b = std::clock();
+    for(unsigned int i = 0; i < edges.size(); ++i)
+	add_edge(edges[i].first, edges[i].second, g);
+    report(graph, shape, num_v, num_e, "add_edge", edges.size(), double(std::clock() - b) / CLOCKS_PER_SEC);
+
+    // edge, half present and half reversed
+    long found = 0;
+    b = std::clock();
+    for(unsigned int i = 0; i < edges.size(); ++i)
+	if(i % 2 == 0)
+	    found += edge(edges[i].first, edges[i].second, g).second;
+	else
+	    found += edge(edges[i].second, edges[i].first, g).second;
+    report(graph, shape, num_v, num_e, "edge", edges.size(), double(std::clock() - b) / CLOCKS_PER_SEC);
+
+    // adjacent_vertices, every out edge of every vertex
+    long visited = 0;
+    b = std::clock();
+    for(int v = 0; v < num_v; ++v) {
+	std::pair<adjacency_iterator, adjacency_iterator> p = adjacent_vertices(v, g);
+	for(; p.first != p.second; ++p.first)
+	    visited += *p.first;}
+    report(graph, shape, num_v, num_e, "adjacent_vertices", num_edges(g), double(std::clock() - b) / CLOCKS_PER_SEC);
+
+    if(acyclic) {
+	// has_cycle, every edge followed once
+	b = std::clock();
+	bool cyclic = has_cycle(g);
+	report(graph, shape, num_v, num_e, "has_cycle", num_edges(g), double(std::clock() - b) / CLOCKS_PER_SEC);
+
+	// topological_sort
+	std::vector<vertex_descriptor> order;
+	order.reserve(num_v);
+	bool threw = false;
+	b = std::clock();
+	try {
+	    topological_sort(g, std::back_inserter(order));}
+	catch(boost::not_a_dag&) {
+	    threw = true;}
+	report(graph, shape, num_v, num_e, "topological_sort", num_edges(g), double(std::clock() - b) / CLOCKS_PER_SEC);
+	if(cyclic || threw)
+	    std::fprintf(stderr, "%s,%s,%ld: acyclic shape reported a cycle\n", graph, shape, num_e);}
+
+    // teardown, every row and the graph itself
+    b = std::clock();
+    delete built;
+    report(graph, shape, num_v, num_e, "teardown", num_v, double(std::clock() - b) / CLOCKS_PER_SEC);
+
+    // keep the work observable
+    if(found + visited == -1)
+	std::printf("\n");}
+
+// ---------
+// bulk_load
+// ---------
+
+/**
+ * times the bulk constructor, only Graph and arena_graph have one
+ */
+template <typename G>
+void bulk_load (const char* graph, const char* shape, int (*make) (long, edge_list&), bool, long num_e) {
+    edge_list edges;
+    int num_v = input(make, num_e, edges);
+    std::clock_t b = std::clock();
+    G g(num_v, edges.begin(), edges.end());
+    report(graph, shape, num_v, num_e, "add_edges", edges.size(), double(std::clock() - b) / CLOCKS_PER_SEC);}
+
+// -------
+// isolate
+// -------
+
+typedef void (*bench_case) (const char*, const char*, int (*) (long, edge_list&), bool, long);
+
+/**
+ * runs one case in a child process, so its peak RSS is its own
+ */
+void isolate (bench_case run, const char* graph, const char* shape, int (*make) (long, edge_list&), bool acyclic, long num_e) {
+    std::fflush(stdout);
+    pid_t pid = fork();
+    if(pid == 0) {
+	run(graph, shape, make, acyclic, num_e);
+	std::fflush(stdout);
+	std::exit(0);}
+    int status;
+    waitpid(pid, &status, 0);}
+
+// ----
+// main
+// ----
+
+int main (int argc, char* argv[]) {
+    using namespace boost;
+    typedef adjacency_list<setS, vecS, directedS> boost_graph;
+
+    long max_edges = argc > 1 ? std::atol(argv[1]) : 1000000;
+    const char* shapes[] = {"sparse", "dense", "chain", "layered", "tiled"};
+    int (*makes[]) (long, edge_list&) = {sparse, dense, chain, layered, tiled};
+    const bool acyclic[] = {false, false, true, true, false};
+
+    std::printf("graph,shape,vertices,edges,op,count,seconds,per_second,peak_rss_kb\n");
+    for(long num_e = 1000; num_e <= max_edges; num_e *= 10)
+	for(int s = 0; s < 5; ++s) {
+	    isolate(bulk_load<Graph>, "Graph", shapes[s], makes[s], acyclic[s], num_e);
+	    isolate(bench<Graph>, "Graph", shapes[s], makes[s], acyclic[s], num_e);
+	    isolate(bulk_load<arena_graph>, "arena_graph", shapes[s], makes[s], acyclic[s], num_e);
+	    isolate(bench<arena_graph>, "arena_graph", shapes[s], makes[s], acyclic[s], num_e);
+	    isolate(bench<boost_graph>, "adjacency_list", shapes[s], makes[s], acyclic[s], num_e);}
+    return 0;}
@@ -0,0 +1,153 @@
+// -------------------------
+// projects/graph/CsrGraph.h
+// Copyright (C) 2012
+// Glenn P. Downing
+// -------------------------
+
+#ifndef CsrGraph_h
+#define CsrGraph_h
+
+// --------
+// includes
+// --------
+
+#include <algorithm> // copy, sort, unique
+#include <cassert>   // assert
+#include <cstddef>   // size_t
+#include <utility>   // pair
+#include <vector>    // vector
+
+#include "CsrView.h"
+#include "Graph.h"
+
+// --------
+// CsrGraph
+// --------
+
+/**
+ * an immutable graph in compressed sparse row form, held in vectors
+ * its interface is csr_view's
+ */
+class CsrGraph : public csr_view<CsrGraph, std::size_t, int> {
+    private:
+        // ----
+        // data
+        // ----
+
+	//row starts, one per vertex plus a final end
+	std::vector<std::size_t> offsets;
+	//out vertices of every row, back to back
+	std::vector<vertex_descriptor> targets;
+
+	// ------------------
+	// csr_view interface
+	// ------------------
+
+	friend class csr_view<CsrGraph, std::size_t, int>;
+
+	const std::size_t* csr_offsets () const {
+	    return &offsets[0];}
+
+	const vertex_descriptor* csr_targets () const {
+	    return targets.empty() ? 0 : &targets[0];}
+
+	std::size_t csr_vertices () const {
+	    return offsets.size() - 1;}
+
+	std::size_t csr_edges () const {
+	    return targets.size();}
+
+	// ----------
+	// sort_rows
+	// ----------
+
+	/**
+	 * helper method that sorts every row and drops duplicate edges,
+	 *     closing the gaps left behind
+	 */
+	void sort_rows() {
+	    std::size_t out = 0;
+	    for(unsigned int v = 0; v + 1 < offsets.size(); ++v) {
+		std::vector<vertex_descriptor>::iterator b = targets.begin() + offsets[v];
+		std::vector<vertex_descriptor>::iterator e = targets.begin() + offsets[v + 1];
+		std::sort(b, e);
+		e = std::unique(b, e);
+		offsets[v] = out;
+		out = std::copy(b, e, targets.begin() + out) - targets.begin();}
+	    offsets.back() = out;
+	    targets.resize(out);}
+
+        // -----
+        // valid
+        // -----
+
+        /**
+         * Gurantees validity of the graph values
+         */
+        bool valid () const {
+	    assert(!offsets.empty());
+	    assert(offsets.front() == 0);
+	    assert(offsets.back() == targets.size());
+	    for(unsigned int v = 0; v + 1 < offsets.size(); ++v)
+		assert(offsets[v] <= offsets[v + 1]);
+	    for(unsigned int i = 0; i < targets.size(); ++i)
+		assert(targets[i] >= 0 && (std::size_t)targets[i] < offsets.size() - 1);
+            return true;}
+
+    public:
+        // ------------
+        // constructors
+        // ------------
+
+        /**
+         * freezes a Graph, keeping its vertex_descriptors
+	 *     removed vertices become vertices without edges
+	 * @param g a Graph
+         */
+        explicit CsrGraph (const Graph& g) :
+		offsets(vertex_bound(g) + 1, 0) {
+	    targets.reserve(num_edges(g));
+	    for(unsigned int v = 0; v < vertex_bound(g); ++v) {
+		std::pair<Graph::adjacency_iterator, Graph::adjacency_iterator> p =
+		    adjacent_vertices(v, g);
+		targets.insert(targets.end(), p.first, p.second);
+		offsets[v + 1] = targets.size();}
+	    sort_rows();
+	    assert(valid());}
+
+        /**
+         * builds a graph from a range of (source, target) pairs,
+	 *     duplicate edges are dropped
+	 * @param n the number of vertices
+	 * @param b a beginning input iterator over pairs of vertex_descriptors
+	 * @param e an end input iterator
+         */
+	template <typename II>
+        CsrGraph (vertices_size_type n, II b, II e) :
+		offsets(n + 1, 0) {
+	    std::vector< std::pair<vertex_descriptor, vertex_descriptor> > input(b, e);
+#if GRAPH_CHECK >= 1
+	    // the counting sort indexes by source, check before it writes
+	    for(unsigned int i = 0; i < input.size(); ++i) {
+		assert(input[i].first >= 0 && (std::size_t)input[i].first < n);
+		assert(input[i].second >= 0 && (std::size_t)input[i].second < n);}
+#endif
+	    // counting sort by source
+	    for(unsigned int i = 0; i < input.size(); ++i)
+		++offsets[input[i].first + 1];
+	    for(unsigned int v = 0; v < n; ++v)
+		offsets[v + 1] += offsets[v];
+	    targets.resize(input.size());
+	    std::vector<std::size_t> next(offsets.begin(), offsets.end() - 1);
+	    for(unsigned int i = 0; i < input.size(); ++i)
+		targets[next[input[i].first]++] = input[i].second;
+	    sort_rows();
+	    assert(valid());}
+
+        // Default copy, destructor, and copy assignment
+        // CsrGraph  (const CsrGraph&);
+        // ~CsrGraph ();
+        // CsrGraph& operator = (const CsrGraph&);
+    };
+
+#endif // CsrGraph_h
@@ -0,0 +1,199 @@
+// ------------------------
+// projects/graph/CsrView.h
+// Copyright (C) 2012
+// Glenn P. Downing
+// ------------------------
+
+#ifndef CsrView_h
+#define CsrView_h
+
+// --------
+// includes
+// --------
+
+#include <algorithm> // lower_bound, upper_bound
+#include <cstddef>   // size_t
+#include <iterator>  // random_access_iterator_tag
+#include <utility>   // make_pair, pair
+#include "boost/iterator/counting_iterator.hpp" // counting_iterator
+
+// --------
+// csr_view
+// --------
+
+/**
+ * the read-only graph interface of a graph in compressed sparse row form,
+ *     shared by CsrGraph and MappedGraph
+ * the out vertices of vertex v are targets[offsets[v]] .. targets[offsets[v + 1]]
+ * each row is sorted, edge_descriptors are positions in targets
+ *     so edges are numbered in (source, target) order
+ * D derives from csr_view<D, O, T> and gives it, through csr_offsets(),
+ *     csr_targets(), csr_vertices() and csr_edges(), its num_vertices + 1
+ *     offsets of type O and its targets of type T
+ */
+template <typename D, typename O, typename T>
+class csr_view {
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef int vertex_descriptor;
+        typedef int edge_descriptor;
+
+        //counting iterators over the integers 0 .. N-1, tagged like Graph's
+        typedef boost::counting_iterator<vertex_descriptor, std::random_access_iterator_tag> vertex_iterator;
+        typedef boost::counting_iterator<edge_descriptor, std::random_access_iterator_tag> edge_iterator;
+        typedef const T* adjacency_iterator;
+
+        typedef std::size_t vertices_size_type;
+        typedef std::size_t edges_size_type;
+
+    private:
+        // ---------
+        // accessors
+        // ---------
+
+        // D befriends csr_view, not csr_view's friends, so they reach D through these
+
+        static const O* offsets_of (const D& g) {
+            return g.csr_offsets();}
+
+        static const T* targets_of (const D& g) {
+            return g.csr_targets();}
+
+        static std::size_t vertices_of (const D& g) {
+            return g.csr_vertices();}
+
+        static std::size_t edges_of (const D& g) {
+            return g.csr_edges();}
+
+    public:
+        // -----------------
+        // adjacent_vertices
+        // -----------------
+
+        /**
+	 * get an iterator over the vertices adjacent to a vertex
+	 * @param v the out vertex_descriptor
+	 * @param g a CSR graph
+	 * @return a pair: the first value a begining iterator,
+	 *      the second value an end iterator, both over the out vertex_descriptors
+         */
+        friend std::pair<adjacency_iterator, adjacency_iterator> adjacent_vertices (vertex_descriptor v, const D& g) {
+	    const O* offsets = offsets_of(g);
+            return std::make_pair(targets_of(g) + offsets[v], targets_of(g) + offsets[v + 1]);}
+
+        // ----
+        // edge
+        // ----
+
+        /**
+	 * get the edge_descriptor, if it exists, for a out,in pair of
+	 *	vertex_descriptors, binary searches the source's row
+	 * @param source the out vertex_descriptor
+	 * @param destination the in vertex_descriptor
+	 * @param g a CSR graph
+	 * @return a pair: the first value being the edge_descriptor,
+	 *                 the second a bool, true of the edge exists
+         */
+        friend std::pair<edge_descriptor, bool> edge (vertex_descriptor source, vertex_descriptor destination, const D& g) {
+	    std::pair<adjacency_iterator, adjacency_iterator> p = adjacent_vertices(source, g);
+	    adjacency_iterator i = std::lower_bound(p.first, p.second, destination);
+	    if(i != p.second && *i == destination)
+		return std::make_pair(i - targets_of(g), true);
+            return std::make_pair(edges_of(g), false);}
+
+        // -----
+        // edges
+        // -----
+
+        /**
+	 * get an iterator over the edges in the graph
+	 * @param g a CSR graph
+	 * @return a pair: the first value a begining iterator,
+	 *      the second value an end iterator, both over the edge_descriptors
+         */
+        friend std::pair<edge_iterator, edge_iterator> edges (const D& g) {
+            return std::make_pair(edge_iterator(0), edge_iterator(edges_of(g)));}
+
+        // ---------
+        // num_edges
+        // ---------
+
+        /**
+	 * returns the number of edges in the graph g
+	 * @param g a CSR graph
+	 * @return the number of edges in the graph
+         */
+        friend edges_size_type num_edges (const D& g) {
+            return edges_of(g);}
+
+        // ------------
+        // num_vertices
+        // ------------
+
+        /**
+	 * returns the number of vertices in the graph g
+	 * @param g a CSR graph
+	 * @return the number of vertices in the graph
+         */
+        friend vertices_size_type num_vertices (const D& g) {
+            return vertices_of(g);}
+
+        // ------
+        // source
+        // ------
+
+        /**
+	 * returns the out vertex for a given edge
+	 * binary searches offsets, O(log V)
+	 * @param ed the edge_descriptor for an edge in the graph
+	 * @param g a CSR graph
+	 * @return a vertex_descriptor
+         */
+        friend vertex_descriptor source (edge_descriptor ed, const D& g) {
+	    const O* offsets = offsets_of(g);
+	    const O* i = std::upper_bound(offsets, offsets + vertices_of(g) + 1, (O)ed);
+            return (i - offsets) - 1;}
+
+        // ------
+        // target
+        // ------
+
+        /**
+	 * returns the in vertex for a given edge
+	 * @param ed the edge_descriptor for an edge in the graph
+	 * @param g a CSR graph
+	 * @return a vertex_descriptor
+         */
+        friend vertex_descriptor target (edge_descriptor ed, const D& g) {
+            return targets_of(g)[ed];}
+
+        // ------
+        // vertex
+        // ------
+
+        /**
+	 * get the vertex_descriptor for the nth vertex of the graph
+	 * @param n a element of vertices_size_type
+	 * @return the vertex_descriptor
+         */
+        friend vertex_descriptor vertex (vertices_size_type n, const D&) {
+            return n;}
+
+        // --------
+        // vertices
+        // --------
+
+        /**
+	 * get an iterator over the vertices in the graph
+	 * @param g a CSR graph
+	 * @return a pair: the first value a begining iterator,
+	 *      the second value an end iterator, both over the vertex_descriptors
+         */
+        friend std::pair<vertex_iterator, vertex_iterator> vertices (const D& g) {
+            return std::make_pair(vertex_iterator(0), vertex_iterator(vertices_of(g)));}
+    };
+
+#endif // CsrView_h
@@ -13,34 +13,448 @@
 
 #include <cassert> // assert
 #include <cstddef> // size_t
-#include <utility> // make_pair, pair
+#include <utility> // make_pair, pair, swap
 #include <vector>  // vector
+#include <iterator> // back_inserter, random_access_iterator_tag
 #include <deque>   // deque
-#include <algorithm> // find
+#include <algorithm> // copy, find, inplace_merge, sort
+#include <limits>    // numeric_limits
+#include <memory>    // allocator
+#include <stdexcept> // length_error
 #include <iostream>   // cout and endl
+#include "boost/config.hpp"          // BOOST_SYMBOL_VISIBLE
 #include "boost/graph/exception.hpp" // not_a_dag
+#include "boost/iterator/counting_iterator.hpp" // counting_iterator
+#include "boost/iterator/filter_iterator.hpp"   // filter_iterator
+#include "boost/iterator/transform_iterator.hpp" // transform_iterator
+
+// -----------
+// GRAPH_CHECK
+// -----------
+
+// the invariant checks asserted by every function that modifies a Graph
+//     0 - none
+//     1 - O(1) checks of the touched vertex or edge
+//     2 - the full O(V + E) audit, also available as validate(g)
+// like every assert, the checks vanish when NDEBUG is defined
+#ifndef GRAPH_CHECK
+#define GRAPH_CHECK 1
+#endif
+
+// -----------
+// GRAPH_STATS
+// -----------
+
+// 1 counts the edge lookups, row reallocations and algorithm work of every
+//     Graph, see graph_stats(g), the counters are atomic so it needs C++11
+// 0, the default, compiles every counter out
+// the setting picks Graph's counters type, so translation units built with
+//     different settings see different Graph types, see basic_graph
+#ifndef GRAPH_STATS
+#define GRAPH_STATS 0
+#endif
+
+#if GRAPH_STATS
+#if __cplusplus < 201103L
+#error "GRAPH_STATS 1 requires C++11 atomics"
+#endif
+#include <atomic> // atomic, memory_order_relaxed
+#include <mutex>  // lock_guard, mutex
+#endif
+
+// --------------------
+// algorithm_statistics
+// --------------------
+
+/**
+ * the work of one algorithm call
+ * vertices and edges count each vertex reached and each edge followed,
+ *     max_depth is the deepest its stack or queue grew
+ */
+struct algorithm_statistics {
+    const char* algorithm;
+    std::size_t vertices;
+    std::size_t edges;
+    std::size_t max_depth;
+
+    explicit algorithm_statistics (const char* algorithm = "") :
+	    algorithm(algorithm),
+	    vertices(0),
+	    edges(0),
+	    max_depth(0) {}};
+
+// ----------------
+// graph_statistics
+// ----------------
+
+/**
+ * the counters of a Graph since it was built or last reset
+ * edge_probes counts the etable slots inspected by edge_lookups,
+ *     max_probe the most inspected by one lookup
+ * row_reallocations counts the adjacency rows that grew their storage
+ * the algorithm totals add up every call, last holds the latest one
+ */
+struct graph_statistics {
+    std::size_t edge_lookups;
+    std::size_t edge_probes;
+    std::size_t max_probe;
+    std::size_t row_reallocations;
+    std::size_t algorithm_calls;
+    std::size_t vertices_visited;
+    std::size_t edges_visited;
+    std::size_t max_depth;
+    algorithm_statistics last;
+
+    graph_statistics () :
+	    edge_lookups(0),
+	    edge_probes(0),
+	    max_probe(0),
+	    row_reallocations(0),
+	    algorithm_calls(0),
+	    vertices_visited(0),
+	    edges_visited(0),
+	    max_depth(0) {}};
+
+// ----------
+// write_json
+// ----------
+
+/**
+ * writes the counters as one JSON object, for attaching to a trace
+ * @param out an output stream
+ * @param s the counters
+ * @return out
+ */
+inline std::ostream& write_json (std::ostream& out, const graph_statistics& s) {
+    return out << "{\"edge_lookups\":"      << s.edge_lookups
+	       << ",\"edge_probes\":"       << s.edge_probes
+	       << ",\"max_probe\":"         << s.max_probe
+	       << ",\"row_reallocations\":" << s.row_reallocations
+	       << ",\"algorithm_calls\":"   << s.algorithm_calls
+	       << ",\"vertices_visited\":"  << s.vertices_visited
+	       << ",\"edges_visited\":"     << s.edges_visited
+	       << ",\"max_depth\":"         << s.max_depth
+	       << ",\"last\":{\"algorithm\":\"" << s.last.algorithm
+	       << "\",\"vertices\":"        << s.last.vertices
+	       << ",\"edges\":"             << s.last.edges
+	       << ",\"max_depth\":"         << s.last.max_depth << "}}";}
+
+// -----------------
+// no_graph_counters
+// -----------------
+
+/**
+ * the counters of a Graph when GRAPH_STATS is 0
+ * every update is an empty inline call, so the compiler drops it along
+ *     with the work that fed it
+ */
+struct no_graph_counters {
+    void lookup (std::size_t) const {}
+    void reallocations (std::size_t) const {}
+    void record (const algorithm_statistics&) const {}
+    graph_statistics snapshot () const {
+	return graph_statistics();}
+    void reset () {}};
+
+#if GRAPH_STATS
+// --------------
+// graph_counters
+// --------------
+
+/**
+ * the counters of a Graph when GRAPH_STATS is 1
+ * const lookups and algorithms update them, so threads may share one
+ *     Graph: the totals are relaxed atomics and the latest call sits
+ *     behind a mutex
+ * a snapshot taken while other threads count may mix totals from just
+ *     before and just after one of their calls
+ */
+class graph_counters {
+    private:
+	typedef std::atomic<std::size_t> counter;
+
+	mutable counter edge_lookups;
+	mutable counter edge_probes;
+	mutable counter max_probe;
+	mutable counter row_reallocations;
+	mutable counter algorithm_calls;
+	mutable counter vertices_visited;
+	mutable counter edges_visited;
+	mutable counter max_depth;
+	mutable std::mutex last_lock;
+	mutable algorithm_statistics last;
+
+	/**
+	 * helper method that raises a maximum to n
+	 */
+	static void raise (counter& c, std::size_t n) {
+	    std::size_t m = c.load(std::memory_order_relaxed);
+	    while(m < n && !c.compare_exchange_weak(m, n, std::memory_order_relaxed)) {}}
+
+	/**
+	 * helper method that sets every counter from a snapshot
+	 */
+	void assign (const graph_statistics& s) {
+	    edge_lookups      = s.edge_lookups;
+	    edge_probes       = s.edge_probes;
+	    max_probe         = s.max_probe;
+	    row_reallocations = s.row_reallocations;
+	    algorithm_calls   = s.algorithm_calls;
+	    vertices_visited  = s.vertices_visited;
+	    edges_visited     = s.edges_visited;
+	    max_depth         = s.max_depth;
+	    std::lock_guard<std::mutex> lock(last_lock);
+	    last = s.last;}
+
+    public:
+	graph_counters () {
+	    assign(graph_statistics());}
+
+	graph_counters (const graph_counters& that) {
+	    assign(that.snapshot());}
+
+	graph_counters& operator = (const graph_counters& that) {
+	    if(this != &that)
+		assign(that.snapshot());
+	    return *this;}
+
+	void lookup (std::size_t probes) const {
+	    edge_lookups.fetch_add(1, std::memory_order_relaxed);
+	    edge_probes.fetch_add(probes, std::memory_order_relaxed);
+	    raise(max_probe, probes);}
+
+	void reallocations (std::size_t n) const {
+	    if(n != 0)
+		row_reallocations.fetch_add(n, std::memory_order_relaxed);}
+
+	void record (const algorithm_statistics& a) const {
+	    algorithm_calls.fetch_add(1, std::memory_order_relaxed);
+	    vertices_visited.fetch_add(a.vertices, std::memory_order_relaxed);
+	    edges_visited.fetch_add(a.edges, std::memory_order_relaxed);
+	    raise(max_depth, a.max_depth);
+	    std::lock_guard<std::mutex> lock(last_lock);
+	    last = a;}
+
+	graph_statistics snapshot () const {
+	    graph_statistics s;
+	    s.edge_lookups      = edge_lookups.load(std::memory_order_relaxed);
+	    s.edge_probes       = edge_probes.load(std::memory_order_relaxed);
+	    s.max_probe         = max_probe.load(std::memory_order_relaxed);
+	    s.row_reallocations = row_reallocations.load(std::memory_order_relaxed);
+	    s.algorithm_calls   = algorithm_calls.load(std::memory_order_relaxed);
+	    s.vertices_visited  = vertices_visited.load(std::memory_order_relaxed);
+	    s.edges_visited     = edges_visited.load(std::memory_order_relaxed);
+	    s.max_depth         = max_depth.load(std::memory_order_relaxed);
+	    std::lock_guard<std::mutex> lock(last_lock);
+	    s.last = last;
+	    return s;}
+
+	void reset () {
+	    assign(graph_statistics());}};
+
+// the counters of Graph, set by GRAPH_STATS
+typedef graph_counters default_graph_counters;
+#else
+typedef no_graph_counters default_graph_counters;
+#endif
+
+template <typename G, typename OI>
+void topological_sort (const G& g, OI x);
+
+// ------------
+// vertex_bound
+// ------------
+
+/**
+ * one more than the largest vertex_descriptor of a graph, the size of a
+ *     table indexed by vertex_descriptor
+ * num_vertices(g) for graphs whose vertex_descriptors are 0 .. N-1,
+ *     Graph overloads it to count removed vertices too
+ * @param g a graph
+ */
+template <typename G>
+std::size_t vertex_bound (const G& g) {
+    return num_vertices(g);}
+
+// ----------------
+// record_algorithm
+// ----------------
+
+/**
+ * called by the algorithms at the end of every call, they always fill a
+ *     and leave dropping the work to counters that record nothing
+ * does nothing for graphs without counters, Graph overloads it
+ * @param g a graph
+ * @param a the work of the call
+ */
+template <typename G>
+void record_algorithm (const G&, const algorithm_statistics&) {}
+
+// --------------
+// copy_allocator
+// --------------
+
+/**
+ * the allocator a copied Graph gives its rows, like the standard's
+ *     select_on_container_copy_construction
+ * a copy of a, allocators whose copies must not share state, like
+ *     arena_allocator, overload it
+ * @param a the allocator of the original
+ */
+template <typename A>
+A copy_allocator (const A& a) {
+    return a;}
+
+// ----------------
+// no_edge_property
+// ----------------
+
+/**
+ * the edge property of a graph that stores none
+ * boost::no_property would make namespace boost associated with every
+ *     Graph, and argument dependent lookup then finds boost's algorithms
+ */
+struct no_edge_property {};
+
+// -----------
+// stored_edge
+// -----------
+
+/**
+ * an entry of the edge list of a basic_graph, its two ends and its property
+ * the no_edge_property specialization keeps an entry at two indices
+ */
+template <typename I, typename P>
+struct stored_edge {
+    I first;
+    I second;
+    P property;
+    stored_edge (I first, I second, const P& property = P()) :
+	    first(first),
+	    second(second),
+	    property(property) {}};
+
+template <typename I>
+struct stored_edge<I, no_edge_property> {
+    I first;
+    I second;
+    stored_edge (I first, I second) :
+	    first(first),
+	    second(second) {}};
 
 // -----
 // Graph
 // -----
 
-class Graph {
+/**
+ * I is the integral type of both descriptors, int or a fixed width type
+ *     like uint32_t or uint64_t, the two largest values of an unsigned I,
+ *     -1 and -2 of a signed one, are reserved, the largest for
+ *     null_vertex() and null_edge(), the second for the edge table's
+ *     removed slots, so an unsigned I names at most its largest value - 1
+ *     vertices and its largest value - 2 edges
+ * P is the property stored with every edge, g[ed] reaches it in O(1),
+ *     no_edge_property stores nothing
+ * the allocator policy A provides the storage of every adjacency row
+ *     std::allocator puts each row on the heap, arena_allocator from
+ *     Arena.h carves them from one arena that is released all at once
+ * A::value_type must be I
+ * C holds the counters, no_graph_counters or graph_counters, the default
+ *     follows GRAPH_STATS so the setting is part of the type: translation
+ *     units built with different settings fail to link a Graph passed
+ *     between them instead of disagreeing on its layout
+ */
+template <typename I = int, typename P = no_edge_property, typename A = std::allocator<I>, typename C = default_graph_counters>
+class basic_graph {
     public:
         // --------
         // typedefs
         // --------
 
-        typedef int vertex_descriptor;
-        typedef int edge_descriptor;
+        typedef I vertex_descriptor;
+        typedef I edge_descriptor;
+        typedef P edge_property_type;
+
+        //predicates that skip removed vertices and edges
+        struct live_vertex {
+            const basic_graph* g;
+            live_vertex (const basic_graph* g = 0) : g(g) {}
+            bool operator () (vertex_descriptor v) const {
+                return g->vremoved.empty() || !g->vremoved[v];}};
+
+        struct live_edge {
+            const basic_graph* g;
+            live_edge (const basic_graph* g = 0) : g(g) {}
+            bool operator () (edge_descriptor ed) const {
+                return g->elist[ed].first != null_vertex();}};
+
+        //maps an in edge to the vertex it comes from
+        struct edge_source {
+            typedef vertex_descriptor result_type;
+            const basic_graph* g;
+            edge_source (const basic_graph* g = 0) : g(g) {}
+            vertex_descriptor operator () (edge_descriptor ed) const {
+                return g->elist[ed].first;}};
 
-        typedef std::vector<int>::const_iterator vertex_iterator;
-        typedef std::vector<int>::const_iterator edge_iterator;
-        typedef std::vector<vertex_descriptor>::const_iterator adjacency_iterator;
+        //counting iterators over the descriptors 0 .. N-1 that skip removed ones
+        //the std tag keeps std algorithms visible to argument dependent lookup
+        typedef boost::counting_iterator<I, std::random_access_iterator_tag> index_iterator;
+        typedef boost::filter_iterator<live_vertex, index_iterator> vertex_iterator;
+        typedef boost::filter_iterator<live_edge, index_iterator> edge_iterator;
+        //the out vertices or in edges of one vertex, in storage from A
+        typedef A                                 allocator_type;
+        typedef std::vector<I, A> row;
+        typedef typename row::const_iterator adjacency_iterator;
+        typedef typename row::const_iterator in_edge_iterator;
+        typedef boost::transform_iterator<edge_source, in_edge_iterator> inv_adjacency_iterator;
 
         typedef std::size_t vertices_size_type;
         typedef std::size_t edges_size_type;
 
     public:
+        // -----------
+        // null_vertex
+        // -----------
+
+        /**
+	 * @return a vertex_descriptor that names no vertex, as in boost's
+	 *     graph_traits, it marks removed vertices in a remapping
+         */
+        static vertex_descriptor null_vertex () {
+	    return vertex_descriptor(-1);}
+
+        // ---------
+        // null_edge
+        // ---------
+
+        /**
+	 * @return an edge_descriptor that names no edge, it marks removed
+	 *     edges in a remapping
+         */
+        static edge_descriptor null_edge () {
+	    return edge_descriptor(-1);}
+
+        // -----------
+        // operator []
+        // -----------
+
+        /**
+	 * the property of an edge, O(1)
+	 * @param ed the edge_descriptor of a contained edge
+	 * @return a reference to the property
+         */
+        edge_property_type& operator [] (edge_descriptor ed) {
+#if GRAPH_CHECK >= 1
+	    assert(valid_edge(ed) && elist[ed].first != null_vertex());
+#endif
+	    return elist[ed].property;}
+
+        const edge_property_type& operator [] (edge_descriptor ed) const {
+#if GRAPH_CHECK >= 1
+	    assert(valid_edge(ed) && elist[ed].first != null_vertex());
+#endif
+	    return elist[ed].property;}
+
         // --------
         // add_edge
         // --------
@@ -52,20 +466,87 @@ class Graph {
 	 * @param g a Graph
 	 * @return a pair: the first value being the edge_descriptor, 
 	 *                 the second a bool, true if edge added
+	 * @throws Boost's not_a_dag exception, leaving g unchanged, if g keeps
+	 *     a topological order and the edge would close a cycle
+	 * @throws std::length_error, leaving g unchanged, if the new edge's
+	 *     descriptor would be reserved
          */
-        friend std::pair<edge_descriptor, bool> add_edge (vertex_descriptor source, vertex_descriptor destination, Graph& g) {
-	    std::pair<edge_descriptor, bool> result 
-		= g.find_edge(source, destination);
-	    if(result.second == true)
-		result.second = false;
-	    else {
-		g.vlist[source].push_back(destination);	
-	    	g.elist.push_back(std::make_pair(source, destination));
-		g.eindices.push_back(g.eindices.size());
-            	result = std::make_pair(g.elist.size() - 1, true); }
+        friend std::pair<edge_descriptor, bool> add_edge (vertex_descriptor source, vertex_descriptor destination, basic_graph& g) {
+#if GRAPH_CHECK == 1
+	    assert(g.valid_vertex(source));
+	    assert(g.valid_vertex(destination));
+#endif
+	    std::pair<edge_descriptor, bool> result = g.insert_edge(source, destination);
+#if GRAPH_CHECK == 1
+	    assert(g.valid_edge(result.first));
+#elif GRAPH_CHECK >= 2
 	    assert(g.valid());
+#endif
+	    return result;}
+
+        /**
+	 * Add a directed edge with a property if the edge isn't already
+	 *     contained, a contained edge keeps its property
+	 * @param source the out vertex_descriptor
+	 * @param destination the in vertex_descriptor
+	 * @param property the edge_property_type of the new edge
+	 * @param g a Graph
+	 * @return a pair: the first value being the edge_descriptor,
+	 *                 the second a bool, true if edge added
+	 * @throws Boost's not_a_dag exception, leaving g unchanged, if g keeps
+	 *     a topological order and the edge would close a cycle
+         */
+        friend std::pair<edge_descriptor, bool> add_edge (vertex_descriptor source, vertex_descriptor destination, const edge_property_type& property, basic_graph& g) {
+	    std::pair<edge_descriptor, bool> result = add_edge(source, destination, g);
+	    if(result.second)
+		g.elist[result.first].property = property;
 	    return result;}
 
+        // ---------
+        // add_edges
+        // ---------
+
+        /**
+	 * Add a range of directed edges to the graph
+	 * same descriptors and duplicate handling as calling add_edge on
+	 *     each pair in order, but storage is sized once up front
+	 * a cycle, if g keeps a topological order, or running out of
+	 *     edge_descriptors throws like add_edge, with the edges before
+	 *     it already added
+	 * @param b a beginning forward iterator over pairs of vertex_descriptors
+	 * @param e an end forward iterator
+	 * @param g a Graph
+	 * @return the number of edges added
+         */
+	template <typename FI>
+        friend edges_size_type add_edges (FI b, FI e, basic_graph& g) {
+	    // size every container for the whole batch, duplicates included
+	    // the sorted sources give the degrees of just the rows it touches
+	    std::vector<vertex_descriptor> sources;
+	    for(FI i = b; i != e; ++i) {
+#if GRAPH_CHECK == 1
+		assert(g.valid_vertex(i->first));
+		assert(g.valid_vertex(i->second));
+#endif
+		sources.push_back(i->first);}
+	    reserve_edges(g.elist.size() + sources.size(), g);
+	    std::sort(sources.begin(), sources.end());
+	    for(std::size_t i = 0, j = 0; i < sources.size(); i = j) {
+		while(j < sources.size() && sources[j] == sources[i])
+		    ++j;
+		row& adjacent = g.vlist[sources[i]];
+		const std::size_t capacity = adjacent.capacity();
+		grow(adjacent, adjacent.size() + (j - i));
+		g.stats.reallocations(adjacent.capacity() != capacity);}
+
+	    edges_size_type before = g.elist.size();
+	    for(; b != e; ++b)
+		g.insert_edge(b->first, b->second);
+#if GRAPH_CHECK >= 2
+	    assert(g.valid());
+#endif
+	    return g.elist.size() - before;}
+
         // ----------
         // add_vertex
         // ----------
@@ -74,11 +555,23 @@ class Graph {
          * add a vertex to the graph g
 	 * @param g a Graph
 	 * @return the vertex_descriptor for the new vertex
+	 * @throws std::length_error, leaving g unchanged, if the new vertex's
+	 *     descriptor would be null_vertex()
          */
-        friend vertex_descriptor add_vertex (Graph& g) {
-            g.vlist.push_back(std::vector<vertex_descriptor>());
-	    g.vindices.push_back(g.vindices.size());
+        friend vertex_descriptor add_vertex (basic_graph& g) {
+	    if(g.vlist.size() >= descriptor_bound(null_vertex()))
+		throw std::length_error("add_vertex: out of vertex_descriptors");
+            g.vlist.push_back(row(g.alloc));
+	    if(g.bidirectional)
+		g.ilist.push_back(row(g.alloc));
+	    if(!g.vremoved.empty())
+		g.vremoved.push_back(0);
+	    if(g.ordered) {
+		g.position.push_back(g.order.size());
+		g.order.push_back(g.vlist.size() - 1);}
+#if GRAPH_CHECK >= 2
 	    assert(g.valid());
+#endif
             return g.vlist.size() - 1;}
 
         // -----------------
@@ -92,7 +585,7 @@ class Graph {
 	 * @return a pair: the first value a begining iterator, 
 	 *      the second value an end iterator, both over the out vertex_descriptors
          */
-        friend std::pair<adjacency_iterator, adjacency_iterator> adjacent_vertices (vertex_descriptor v, const Graph& g) {
+        friend std::pair<adjacency_iterator, adjacency_iterator> adjacent_vertices (vertex_descriptor v, const basic_graph& g) {
 	    adjacency_iterator b = g.vlist[v].begin();
 	    adjacency_iterator e = g.vlist[v].end();
             return std::make_pair(b, e);}
@@ -110,7 +603,7 @@ class Graph {
 	 * @return a pair: the first value being the edge_descriptor, 
 	 *                 the second a bool, true of the edge exists
          */
-        friend std::pair<edge_descriptor, bool> edge (vertex_descriptor source, vertex_descriptor destination, const Graph& g) {
+        friend std::pair<edge_descriptor, bool> edge (vertex_descriptor source, vertex_descriptor destination, const basic_graph& g) {
             return g.find_edge(source, destination);}
 
         // -----
@@ -123,8 +616,90 @@ class Graph {
 	 * @return a pair: the first value a begining iterator, 
 	 *      the second value an end iterator, both over the edge_descriptors
          */
-        friend std::pair<edge_iterator, edge_iterator> edges (const Graph& g) {
-            return std::make_pair(g.eindices.begin(), g.eindices.end());}
+        friend std::pair<edge_iterator, edge_iterator> edges (const basic_graph& g) {
+	    index_iterator b(0);
+	    index_iterator e(g.elist.size());
+            return std::make_pair(edge_iterator(live_edge(&g), b, e), edge_iterator(live_edge(&g), e, e));}
+
+        // ---------
+        // in_degree
+        // ---------
+
+        /**
+	 * returns the number of edges into a vertex, O(1)
+	 * g must keep its in edges, see keep_in_edges
+	 * @param v the in vertex_descriptor
+	 * @param g a Graph
+	 * @return the in-degree of v
+         */
+        friend edges_size_type in_degree (vertex_descriptor v, const basic_graph& g) {
+#if GRAPH_CHECK >= 1
+	    assert(g.bidirectional);
+#endif
+            return g.ilist[v].size();}
+
+        // --------
+        // in_edges
+        // --------
+
+        /**
+	 * get an iterator over the edges into a vertex, in the order they
+	 *     were added, O(1)
+	 * g must keep its in edges, see keep_in_edges
+	 * @param v the in vertex_descriptor
+	 * @param g a Graph
+	 * @return a pair: the first value a begining iterator,
+	 *      the second value an end iterator, both over the edge_descriptors
+         */
+        friend std::pair<in_edge_iterator, in_edge_iterator> in_edges (vertex_descriptor v, const basic_graph& g) {
+#if GRAPH_CHECK >= 1
+	    assert(g.bidirectional);
+#endif
+	    in_edge_iterator b = g.ilist[v].begin();
+	    in_edge_iterator e = g.ilist[v].end();
+            return std::make_pair(b, e);}
+
+        // ---------------------
+        // inv_adjacent_vertices
+        // ---------------------
+
+        /**
+	 * get an iterator over the vertices with an edge into a vertex, O(1)
+	 * g must keep its in edges, see keep_in_edges
+	 * @param v the in vertex_descriptor
+	 * @param g a Graph
+	 * @return a pair: the first value a begining iterator,
+	 *      the second value an end iterator, both over the out vertex_descriptors
+         */
+        friend std::pair<inv_adjacency_iterator, inv_adjacency_iterator> inv_adjacent_vertices (vertex_descriptor v, const basic_graph& g) {
+	    std::pair<in_edge_iterator, in_edge_iterator> p = in_edges(v, g);
+	    inv_adjacency_iterator b(p.first, edge_source(&g));
+	    inv_adjacency_iterator e(p.second, edge_source(&g));
+            return std::make_pair(b, e);}
+
+        // -------------
+        // keep_in_edges
+        // -------------
+
+        /**
+	 * from now on, keep the in edges of every vertex next to its out
+	 *     vertices, O(V + E) once and O(1) more per added edge
+	 * in_edges, in_degree and inv_adjacent_vertices need it, and
+	 *     clear_vertex and remove_vertex drop to O(degree)
+	 * @param g a Graph
+         */
+        friend void keep_in_edges (basic_graph& g) {
+	    if(g.bidirectional)
+		return;
+	    g.ilist.assign(g.vlist.size(), row(g.alloc));
+	    for(std::size_t ed = 0; ed < g.elist.size(); ++ed)
+		if(g.elist[ed].first != null_vertex())
+		    g.ilist[g.elist[ed].second].push_back(ed);
+	    g.bidirectional = true;
+#if GRAPH_CHECK >= 2
+	    assert(g.valid());
+#endif
+	    }
 
         // ---------
         // num_edges
@@ -135,8 +710,8 @@ class Graph {
 	 * @param g a graph
 	 * @return the number of edges in the graph
          */
-        friend edges_size_type num_edges (const Graph& g) {
-            return g.elist.size();}
+        friend edges_size_type num_edges (const basic_graph& g) {
+            return g.elist.size() - g.removed_edges;}
 
         // ------------
         // num_vertices
@@ -147,8 +722,21 @@ class Graph {
 	 * @param g a graph
 	 * @return the number of vertices in the graph
          */
-        friend vertices_size_type num_vertices (const Graph& g) {
-            return g.vlist.size();}
+        friend vertices_size_type num_vertices (const basic_graph& g) {
+            return g.vlist.size() - g.removed_vertices;}
+
+        // ----------
+        // out_degree
+        // ----------
+
+        /**
+	 * returns the number of edges out of a vertex, O(1)
+	 * @param v the out vertex_descriptor
+	 * @param g a Graph
+	 * @return the out-degree of v
+         */
+        friend edges_size_type out_degree (vertex_descriptor v, const basic_graph& g) {
+            return g.vlist[v].size();}
 
         // ------
         // source
@@ -158,9 +746,9 @@ class Graph {
 	 * returns the out vertex for a given edge
 	 * @param ed the edge_descriptor for an edge in the graph
 	 * @param g a graph
-	 * @return a vertex_descriptor
+	 * @return a vertex_descriptor, -1 if the edge was removed
          */
-        friend vertex_descriptor source (edge_descriptor ed, const Graph& g) {
+        friend vertex_descriptor source (edge_descriptor ed, const basic_graph& g) {
             return g.elist[ed].first;}
 
         // ------
@@ -171,9 +759,9 @@ class Graph {
 	 * returns the in vertex for a given edge
 	 * @param ed the edge_descriptor for an edge in the graph
 	 * @param g a graph
-	 * @return a vertex_descriptor
+	 * @return a vertex_descriptor, -1 if the edge was removed
          */
-        friend vertex_descriptor target (edge_descriptor ed, const Graph& g) {
+        friend vertex_descriptor target (edge_descriptor ed, const basic_graph& g) {
             return g.elist[ed].second;}
 
         // ------
@@ -182,11 +770,12 @@ class Graph {
 
         /**
 	 * get the vertex_descriptor for the nth vertex added to the graph
+	 *     removed vertices keep their place in the count
 	 * @param n a element of vertices_size_type
 	 * @return the vertex_descriptor
          */
-        friend vertex_descriptor vertex (vertices_size_type n, const Graph&) {
-            return n;}
+        friend vertex_descriptor vertex (vertices_size_type n, const basic_graph&) {
+            return vertex_descriptor(n);}
 
         // --------
         // vertices
@@ -198,21 +787,648 @@ class Graph {
 	 * @return a pair: the first value a begining iterator, 
 	 *      the second value an end iterator, both over the vertex_descriptors
          */
-        friend std::pair<vertex_iterator, vertex_iterator> vertices (const Graph& g) {
-            return std::make_pair(g.vindices.begin(), g.vindices.end());}
+        friend std::pair<vertex_iterator, vertex_iterator> vertices (const basic_graph& g) {
+	    index_iterator b(0);
+	    index_iterator e(g.vlist.size());
+            return std::make_pair(vertex_iterator(live_vertex(&g), b, e), vertex_iterator(live_vertex(&g), e, e));}
+
+        // ------------
+        // vertex_bound
+        // ------------
+
+        /**
+	 * one more than the largest vertex_descriptor ever handed out,
+	 *     removed vertices included
+	 * @param g a Graph
+	 * @return the size of a table indexed by vertex_descriptor
+         */
+        friend vertices_size_type vertex_bound (const basic_graph& g) {
+            return g.vlist.size();}
+
+        // -----------
+        // remove_edge
+        // -----------
+
+        /**
+	 * remove the edge source -> destination, if it is contained
+	 * O(out-degree of source), other descriptors stay valid
+	 * @param source the out vertex_descriptor
+	 * @param destination the in vertex_descriptor
+	 * @param g a Graph
+         */
+        friend void remove_edge (vertex_descriptor source, vertex_descriptor destination, basic_graph& g) {
+	    std::pair<edge_descriptor, bool> p = g.find_edge(source, destination);
+	    if(p.second)
+		g.erase_edge(p.first);
+#if GRAPH_CHECK >= 2
+	    assert(g.valid());
+#endif
+	    }
+
+        /**
+	 * remove an edge, O(out-degree of its source)
+	 * @param ed the edge_descriptor of a contained edge
+	 * @param g a Graph
+         */
+        friend void remove_edge (edge_descriptor ed, basic_graph& g) {
+#if GRAPH_CHECK >= 1
+	    assert(g.valid_edge(ed) && g.elist[ed].first != null_vertex());
+#endif
+	    g.erase_edge(ed);
+#if GRAPH_CHECK >= 2
+	    assert(g.valid());
+#endif
+	    }
+
+        // ------------
+        // clear_vertex
+        // ------------
+
+        /**
+	 * remove every edge into or out of a vertex
+	 * each edge is dropped from the row of its other end, so out edges
+	 *     cost O(out-degree) plus the in-degrees of their targets if g
+	 *     keeps its in edges, and in edges O(in-degree) plus the
+	 *     out-degrees of their sources if it does, O(V + E) otherwise
+	 * @param v a vertex_descriptor
+	 * @param g a Graph
+         */
+        friend void clear_vertex (vertex_descriptor v, basic_graph& g) {
+#if GRAPH_CHECK == 1
+	    assert(g.valid_vertex(v));
+#endif
+	    row& out = g.vlist[v];
+	    for(std::size_t i = 0; i < out.size(); ++i) {
+		const edge_descriptor ed = g.find_edge(v, out[i]).first;
+		if(g.bidirectional) {
+		    row& in = g.ilist[out[i]];
+		    in.erase(std::find(in.begin(), in.end(), ed));}
+		g.tombstone_edge(ed);}
+	    out.clear();
+	    if(g.bidirectional) {
+		row& in = g.ilist[v];
+		for(std::size_t i = 0; i < in.size(); ++i) {
+		    row& adjacent = g.vlist[g.elist[in[i]].first];
+		    adjacent.erase(std::find(adjacent.begin(), adjacent.end(), v));
+		    g.tombstone_edge(in[i]);}
+		in.clear();}
+	    else
+		for(std::size_t u = 0; u < g.vlist.size(); ++u) {
+		    row& adjacent = g.vlist[u];
+		    typename row::iterator i = std::find(adjacent.begin(), adjacent.end(), v);
+		    if(i != adjacent.end()) {
+			g.tombstone_edge(g.find_edge(u, v).first);
+			adjacent.erase(i);}}
+#if GRAPH_CHECK >= 2
+	    assert(g.valid());
+#endif
+	    }
+
+        // -------------
+        // remove_vertex
+        // -------------
+
+        /**
+	 * clear a vertex and remove it, other descriptors stay valid
+	 * the descriptor is not reused until compact()
+	 * @param v a vertex_descriptor
+	 * @param g a Graph
+         */
+        friend void remove_vertex (vertex_descriptor v, basic_graph& g) {
+	    clear_vertex(v, g);
+	    if(g.vremoved.empty())
+		g.vremoved.resize(g.vlist.size(), 0);
+	    g.vremoved[v] = 1;
+	    ++g.removed_vertices;
+#if GRAPH_CHECK >= 2
+	    assert(g.valid());
+#endif
+	    }
+
+        // ---------
+        // remapping
+        // ---------
+
+        /**
+	 * the result of compact(), indexed by old descriptors
+	 *     holds the new descriptor, or null_vertex() or null_edge() for
+	 *     a removed one
+         */
+        struct remapping {
+	    std::vector<vertex_descriptor> vertices;
+	    std::vector<edge_descriptor>   edges;};
+
+        // -------
+        // compact
+        // -------
+
+        /**
+	 * reclaim the space of removed vertices and edges, O(V + E)
+	 * surviving vertices and edges are renumbered 0 .. N-1, keeping their
+	 *     relative order, adjacency order and the topological order
+	 * @param g a Graph
+	 * @return the table from old descriptors to new ones
+         */
+        friend remapping compact (basic_graph& g) {
+	    remapping r;
+	    r.vertices.assign(g.vlist.size(), null_vertex());
+	    r.edges.assign(g.elist.size(), null_edge());
+	    vertex_descriptor n = 0;
+	    for(std::size_t v = 0; v < g.vlist.size(); ++v)
+		if(live_vertex(&g)(v))
+		    r.vertices[v] = n++;
+
+	    std::vector<row> vlist(n, row(g.alloc));
+	    for(std::size_t v = 0; v < g.vlist.size(); ++v)
+		if(r.vertices[v] != null_vertex()) {
+		    row& adjacent = vlist[r.vertices[v]];
+		    adjacent.swap(g.vlist[v]);
+		    for(std::size_t i = 0; i < adjacent.size(); ++i)
+			adjacent[i] = r.vertices[adjacent[i]];}
+
+	    std::vector<stored_edge_type> elist;
+	    elist.reserve(g.elist.size() - g.removed_edges);
+	    for(std::size_t ed = 0; ed < g.elist.size(); ++ed)
+		if(g.elist[ed].first != null_vertex()) {
+		    r.edges[ed] = elist.size();
+		    elist.push_back(g.elist[ed]);
+		    elist.back().first  = r.vertices[elist.back().first];
+		    elist.back().second = r.vertices[elist.back().second];}
+
+	    if(g.ordered) {
+		std::vector<vertex_descriptor> order;
+		order.reserve(n);
+		for(std::size_t i = 0; i < g.order.size(); ++i)
+		    if(r.vertices[g.order[i]] != null_vertex())
+			order.push_back(r.vertices[g.order[i]]);
+		g.order.swap(order);
+		g.position.resize(n);
+		for(vertex_descriptor i = 0; i < n; ++i)
+		    g.position[g.order[i]] = i;}
+
+	    if(g.bidirectional) {
+		std::vector<row> ilist(n, row(g.alloc));
+		for(std::size_t ed = 0; ed < elist.size(); ++ed)
+		    ilist[elist[ed].second].push_back(ed);
+		g.ilist.swap(ilist);}
+
+	    g.vlist.swap(vlist);
+	    g.elist.swap(elist);
+	    g.vremoved.clear();
+	    g.removed_vertices = 0;
+	    g.removed_edges = 0;
+	    g.etable.clear();
+	    reserve_edges(g.elist.size(), g);
+	    g.rehash(g.etable.size());
+#if GRAPH_CHECK >= 2
+	    assert(g.valid());
+#endif
+	    return r;}
+
+        // --------
+        // validate
+        // --------
+
+        /**
+	 * audits every vertex and edge of the graph, O(V + E) expected
+	 *     unlike the GRAPH_CHECK asserts it also runs under NDEBUG
+	 * @param g a Graph
+	 * @return true if every invariant holds
+         */
+        friend bool validate (const basic_graph& g) {
+            return g.valid();}
+
+        // -----------
+        // graph_stats
+        // -----------
+
+        /**
+	 * the counters of g, all zero unless GRAPH_STATS is 1
+	 * @param g a Graph
+	 * @return a copy of the counters, see write_json
+         */
+        friend graph_statistics graph_stats (const basic_graph& g) {
+	    return g.stats.snapshot();}
+
+        /**
+	 * zero the counters of g
+	 * @param g a Graph
+         */
+        friend void reset_graph_stats (basic_graph& g) {
+	    g.stats.reset();}
+
+        /**
+	 * adds one algorithm call to the counters of g
+	 * @param g a Graph
+	 * @param a the work of the call
+         */
+        friend void record_algorithm (const basic_graph& g, const algorithm_statistics& a) {
+	    g.stats.record(a);}
+
+        // ----------------
+        // topological_sort
+        // ----------------
+
+        /**
+	 * topological_sort for a Graph
+	 * if g keeps a topological order, writes it out in reverse in O(V),
+	 *     otherwise runs the general algorithm
+	 * @param g a Graph
+	 * @param x an output iterator
+	 * @throws Boost's not_a_dag exception if has_cycle()
+         */
+	template <typename OI>
+        friend void topological_sort (const basic_graph& g, OI x) {
+	    if(!g.ordered) {
+		::topological_sort<basic_graph, OI>(g, x);
+		return;}
+	    for(typename std::vector<vertex_descriptor>::const_reverse_iterator i = g.order.rbegin(); i != g.order.rend(); ++i)
+		if(live_vertex(&g)(*i)) {
+		    *x = *i;
+		    ++x;}
+	    algorithm_statistics a("topological_sort");
+	    a.vertices = g.order.size();
+	    record_algorithm(g, a);
+	    }
+
+        // ----------------------
+        // keep_topological_order
+        // ----------------------
+
+        /**
+	 * from now on, maintain a topological order of g as edges are added
+	 *     add_edge then rejects any edge that would close a cycle, and
+	 *     topological_sort returns the maintained order in O(V)
+	 * an edge that agrees with the order costs O(1), one that does not
+	 *     costs searches and a sort of just the vertices it displaces,
+	 *     see reorder
+	 * the backward search needs the in edges, so g keeps them too
+	 * @param g a Graph
+	 * @throws Boost's not_a_dag exception if g already has a cycle
+         */
+        friend void keep_topological_order (basic_graph& g) {
+	    if(g.ordered)
+		return;
+	    keep_in_edges(g);
+	    std::vector<vertex_descriptor> reversed;
+	    topological_sort<basic_graph>(g, std::back_inserter(reversed));
+	    g.order.assign(reversed.rbegin(), reversed.rend());
+	    // removed vertices keep a place at the end
+	    for(std::size_t v = 0; v < g.vremoved.size(); ++v)
+		if(g.vremoved[v])
+		    g.order.push_back(v);
+	    g.position.resize(g.order.size());
+	    for(std::size_t i = 0; i < g.order.size(); ++i)
+		g.position[g.order[i]] = i;
+	    g.ordered = true;}
+
+        // -------------
+        // reserve_edges
+        // -------------
+
+        /**
+	 * make room for n edges in total, so adding them never reallocates
+	 *     storage at least doubles when it grows, so reserving before
+	 *     each of many small batches stays amortized O(1) per edge
+	 * @param n the number of edges
+	 * @param g a Graph
+         */
+        friend void reserve_edges (edges_size_type n, basic_graph& g) {
+	    grow(g.elist, n);
+	    std::size_t slots = g.etable.empty() ? 16 : g.etable.size();
+	    while(slots < 2 * n)
+		slots *= 2;
+	    if(slots != g.etable.size())
+		g.rehash(slots);}
+
+        // ----------------
+        // reserve_vertices
+        // ----------------
+
+        /**
+	 * make room for n vertices in total, so adding them never reallocates
+	 * @param n the number of vertices
+	 * @param g a Graph
+         */
+        friend void reserve_vertices (vertices_size_type n, basic_graph& g) {
+	    g.vlist.reserve(n);
+	    if(g.bidirectional)
+		g.ilist.reserve(n);}
 
     private:
         // ----
         // data
         // ----
 
+	//the storage of every row, rows share it through their copies
+	allocator_type alloc;
+
 	//containers for the vertices and edges
-        std::vector< std::vector<vertex_descriptor> > vlist;
-	std::vector< std::pair<vertex_descriptor, vertex_descriptor> > elist;
+	//a removed edge is a tombstone of two null_vertex() in elist
+	typedef stored_edge<I, P> stored_edge_type;
+        std::vector<row> vlist;
+	std::vector<stored_edge_type> elist;
+
+	//the optional in edges of every vertex, see keep_in_edges
+	bool bidirectional;
+	std::vector<row> ilist;
+
+	//tombstones for removed vertices, empty until the first removal
+	std::vector<char> vremoved;
+	vertices_size_type removed_vertices;
+	edges_size_type removed_edges;
+
+	//an optional topological order, see keep_topological_order
+	//order holds the vertices by position, position the inverse
+	//reorder marks the vertices it reaches in visited, and clears them
+	bool ordered;
+	std::vector<vertex_descriptor> order;
+	std::vector<std::size_t> position;
+	std::vector<char> visited;
+
+	//the counters, updated by const lookups and algorithms too
+	C stats;
+
+	//open-addressing hash of edge_descriptors keyed on (source, target)
+	//empty slots hold empty_slot(), slots of removed edges removed_slot()
+	//size is always zero or a power of two
+	std::vector<edge_descriptor> etable;
+
+	static edge_descriptor empty_slot () {
+	    return edge_descriptor(-1);}
+
+	static edge_descriptor removed_slot () {
+	    return edge_descriptor(-2);}
+
+	// ----------------
+	// descriptor_bound
+	// ----------------
+
+	/**
+	 * helper method, the number of descriptors 0 .. n - 1 that lie below
+	 *     a sentinel, a signed I keeps its sentinels negative, so every
+	 *     value up to its maximum is free
+	 */
+	static std::size_t descriptor_bound (I sentinel) {
+	    if(std::numeric_limits<I>::is_signed)
+		return std::size_t(std::numeric_limits<I>::max()) + 1;
+	    return std::size_t(sentinel);}
+
+	// ----
+	// grow
+	// ----
+
+	/**
+	 * helper method that makes room for n elements in a vector
+	 *     unlike reserve, at least doubles the capacity when it grows
+	 */
+	template <typename V>
+	static void grow(V& v, std::size_t n) {
+	    if(n > v.capacity())
+		v.reserve(std::max(n, 2 * v.capacity()));}
+
+	// ---------
+	// copy_rows
+	// ---------
+
+	/**
+	 * helper method for the copy constructor, copies rows into storage
+	 *     from this graph's allocator
+	 */
+	void copy_rows(const std::vector<row>& from, std::vector<row>& to) {
+	    to.reserve(from.size());
+	    for(std::size_t i = 0; i < from.size(); ++i)
+		to.push_back(row(from[i].begin(), from[i].end(), alloc));}
+
+	// -----------
+	// insert_edge
+	// -----------
+
+	/**
+	 * helper method shared by add_edge and add_edges
+	 *     appends the edge unless it is already contained
+	 */
+	std::pair<edge_descriptor, bool> insert_edge(vertex_descriptor source,
+		vertex_descriptor destination) {
+	    std::pair<edge_descriptor, bool> result 
+		= find_edge(source, destination);
+	    if(result.second == true)
+		result.second = false;
+	    else {
+		if(elist.size() >= descriptor_bound(removed_slot()))
+		    throw std::length_error("add_edge: out of edge_descriptors");
+		if(ordered)
+		    reorder(source, destination);
+		const std::size_t capacity = vlist[source].capacity();
+		const std::size_t in_capacity = bidirectional ? ilist[destination].capacity() : 0;
+		vlist[source].push_back(destination);	
+	    	elist.push_back(stored_edge_type(source, destination));
+            	result = std::make_pair(elist.size() - 1, true); 
+		if(bidirectional)
+		    ilist[destination].push_back(result.first);
+		stats.reallocations((vlist[source].capacity() != capacity)
+			+ (bidirectional && ilist[destination].capacity() != in_capacity));
+		index_edge(result.first); }
+	    return result;}
+
+	// ----------
+	// erase_edge
+	// ----------
 
-	//iterators for the vertices and edges
-	std::vector<int> vindices;
-	std::vector<int> eindices;
+	/**
+	 * helper method for remove_edge
+	 *     drops a contained edge from its source's adjacency and its
+	 *     destination's in edges, then tombstones it,
+	 *     O(out-degree of the source + in-degree of the destination)
+	 */
+	void erase_edge(edge_descriptor ed) {
+	    const vertex_descriptor source = elist[ed].first;
+	    const vertex_descriptor destination = elist[ed].second;
+	    row& adjacent = vlist[source];
+	    adjacent.erase(std::find(adjacent.begin(), adjacent.end(), destination));
+	    if(bidirectional) {
+		row& in = ilist[destination];
+		in.erase(std::find(in.begin(), in.end(), ed));}
+	    tombstone_edge(ed);}
+
+	// --------------
+	// tombstone_edge
+	// --------------
+
+	/**
+	 * helper method shared by the removal functions
+	 *     frees the etable slot of an edge and leaves a tombstone in
+	 *     elist, the rows are left to the caller, expected O(1)
+	 */
+	void tombstone_edge(edge_descriptor ed) {
+	    std::size_t mask = etable.size() - 1;
+	    std::size_t i = hash_edge(elist[ed].first, elist[ed].second) & mask;
+	    while(etable[i] != ed)
+		i = (i + 1) & mask;
+	    etable[i] = removed_slot();
+	    elist[ed] = stored_edge_type(null_vertex(), null_vertex());
+	    ++removed_edges;}
+
+	// -------
+	// reorder
+	// -------
+
+	/**
+	 * helper method that keeps order topological before the edge
+	 *     source -> destination is added, Pearce and Kelly's algorithm
+	 * if destination is already after source there is nothing to do,
+	 *     otherwise a forward search from destination finds the vertices
+	 *     it reaches before source in the order, a backward search from
+	 *     source those that reach it after destination, and only their
+	 *     positions are reassigned, the backward ones first
+	 * costs O(k log k) for the k vertices found, plus their edges
+	 * @throws Boost's not_a_dag exception, before any change, if source
+	 *     is reachable from destination
+	 */
+	void reorder(vertex_descriptor source, vertex_descriptor destination) {
+	    const std::size_t lower = position[destination];
+	    const std::size_t upper = position[source];
+	    if(lower > upper)
+		return;
+	    if(lower == upper)
+		throw boost::not_a_dag();
+	    if(visited.size() < vlist.size())
+		visited.resize(vlist.size(), 0);
+	    algorithm_statistics a("reorder");
+
+	    // forward, from destination through vertices before source
+	    std::vector<vertex_descriptor> forward(1, destination);
+	    std::vector<vertex_descriptor> stack(1, destination);
+	    visited[destination] = 1;
+	    while(!stack.empty()) {
+		vertex_descriptor v = stack.back();
+		++a.vertices;
+		a.edges += vlist[v].size();
+		a.max_depth = std::max(a.max_depth, stack.size());
+		stack.pop_back();
+		for(std::size_t i = 0; i < vlist[v].size(); ++i) {
+		    vertex_descriptor w = vlist[v][i];
+		    if(w == source) {
+			for(std::size_t j = 0; j < forward.size(); ++j)
+			    visited[forward[j]] = 0;
+			record_algorithm(*this, a);
+			throw boost::not_a_dag();}
+		    if(position[w] < upper && !visited[w]) {
+			visited[w] = 1;
+			forward.push_back(w);
+			stack.push_back(w);}}}
+
+	    // backward, from source through vertices after destination
+	    std::vector<vertex_descriptor> backward(1, source);
+	    stack.push_back(source);
+	    visited[source] = 1;
+	    while(!stack.empty()) {
+		vertex_descriptor v = stack.back();
+		++a.vertices;
+		a.edges += ilist[v].size();
+		a.max_depth = std::max(a.max_depth, stack.size());
+		stack.pop_back();
+		for(std::size_t i = 0; i < ilist[v].size(); ++i) {
+		    vertex_descriptor u = elist[ilist[v][i]].first;
+		    if(position[u] > lower && !visited[u]) {
+			visited[u] = 1;
+			backward.push_back(u);
+			stack.push_back(u);}}}
+	    record_algorithm(*this, a);
+
+	    // the backward vertices take the lowest of the freed positions,
+	    //     each side keeping its relative order
+	    by_position earlier(position);
+	    std::sort(backward.begin(), backward.end(), earlier);
+	    std::sort(forward.begin(), forward.end(), earlier);
+	    std::vector<std::size_t> slots;
+	    slots.reserve(backward.size() + forward.size());
+	    for(std::size_t i = 0; i < backward.size(); ++i)
+		slots.push_back(position[backward[i]]);
+	    for(std::size_t i = 0; i < forward.size(); ++i)
+		slots.push_back(position[forward[i]]);
+	    std::inplace_merge(slots.begin(), slots.begin() + backward.size(), slots.end());
+	    backward.insert(backward.end(), forward.begin(), forward.end());
+	    for(std::size_t i = 0; i < backward.size(); ++i) {
+		visited[backward[i]] = 0;
+		order[slots[i]] = backward[i];
+		position[backward[i]] = slots[i];}}
+
+	// -----------
+	// by_position
+	// -----------
+
+	/**
+	 * helper predicate for reorder, orders vertices by their position
+	 */
+	struct by_position {
+	    const std::vector<std::size_t>& position;
+	    by_position (const std::vector<std::size_t>& position) :
+		    position(position) {}
+	    bool operator () (vertex_descriptor v, vertex_descriptor w) const {
+		return position[v] < position[w];}};
+
+	// ---------
+	// hash_edge
+	// ---------
+
+	/**
+	 * helper method that mixes a (source, destination) pair into a
+	 *     starting slot for etable
+	 */
+	static std::size_t hash_edge(vertex_descriptor source,
+		vertex_descriptor destination) {
+	    std::size_t h = static_cast<std::size_t>(source) * 2654435761u;
+	    h ^= static_cast<std::size_t>(destination) + 0x9e3779b9u + (h << 6) + (h >> 2);
+	    h ^= h >> 16;
+	    h *= 0x45d9f3bu;
+	    h ^= h >> 16;
+	    return h;}
+
+	// ----------
+	// index_edge
+	// ----------
+
+	/**
+	 * helper method that records an edge, already in elist, in etable
+	 *     grows etable so that it is never more than half full
+	 * @param ed the edge_descriptor of the new edge
+	 */
+	void index_edge(edge_descriptor ed) {
+	    if(2 * elist.size() <= etable.size())
+		insert_slot(ed);
+	    else
+		rehash(etable.empty() ? 16 : 2 * etable.size());}
+
+	// ------
+	// rehash
+	// ------
+
+	/**
+	 * helper method that rebuilds etable with a new number of slots
+	 * @param slots a power of two, at least twice the number of edges
+	 */
+	void rehash(std::size_t slots) {
+	    std::vector<edge_descriptor> grown(slots, empty_slot());
+	    etable.swap(grown);
+	    for(std::size_t i = 0; i < elist.size(); ++i)
+		if(elist[i].first != null_vertex())
+		    insert_slot(i);}
+
+	// -----------
+	// insert_slot
+	// -----------
+
+	/**
+	 * helper method that places an edge_descriptor in the first free or
+	 *     removed slot of its probe sequence, etable must have room
+	 */
+	void insert_slot(edge_descriptor ed) {
+	    std::size_t mask = etable.size() - 1;
+	    std::size_t i = hash_edge(elist[ed].first, elist[ed].second) & mask;
+	    while(etable[i] != empty_slot() && etable[i] != removed_slot())
+		i = (i + 1) & mask;
+	    etable[i] = ed;}
 
 	// ---------
 	// find_edge
@@ -221,39 +1437,132 @@ class Graph {
 	/**
 	 * helper method for the special problem of finding an edge,
 	 *     if it exists, from two vertex_descriptors
+	 *     linear probes etable, expected O(1)
+	 * counted in the stats, valid() uses probe_edge so audits are not
 	 */
 	std::pair<edge_descriptor, bool> find_edge(vertex_descriptor source, 
 		vertex_descriptor destination) const {
-	    for(unsigned int i = 0; i < elist.size(); ++i)
-	         if(elist[i].first == source && 
-		    elist[i].second == destination)
-		 	return std::make_pair(i, true);
+	    std::size_t probes;
+	    std::pair<edge_descriptor, bool> result = probe_edge(source, destination, probes);
+	    stats.lookup(probes);
+	    return result;}
+
+	// ----------
+	// probe_edge
+	// ----------
+
+	/**
+	 * helper method for find_edge, the lookup itself
+	 * @param probes set to the number of etable slots inspected
+	 */
+	std::pair<edge_descriptor, bool> probe_edge(vertex_descriptor source,
+		vertex_descriptor destination, std::size_t& probes) const {
+	    probes = 0;
+	    if(!etable.empty()) {
+		std::size_t mask = etable.size() - 1;
+		std::size_t i = hash_edge(source, destination) & mask;
+		while(++probes, etable[i] != empty_slot()) {
+		    if(etable[i] != removed_slot()) {
+			const stored_edge_type& e = elist[etable[i]];
+			if(e.first == source && e.second == destination)
+			    return std::make_pair(etable[i], true);}
+		    i = (i + 1) & mask;}}
 	    return std::make_pair(elist.size(), false);}
 	
+        // ------------
+        // valid_vertex
+        // ------------
+
+        /**
+         * O(1) check that a vertex_descriptor names a live vertex of the graph
+         */
+        bool valid_vertex (vertex_descriptor v) const {
+            return (std::size_t)v < vlist.size() && live_vertex(this)(v);}
+
+        // ----------
+        // valid_edge
+        // ----------
+
+        /**
+         * O(1) check of a single edge and of the sizes of the containers
+         */
+        bool valid_edge (edge_descriptor ed) const {
+	    if((std::size_t)ed >= elist.size())
+		return false;
+	    if(elist[ed].first == null_vertex())
+		return removed_edges != 0;
+	    if(!valid_vertex(elist[ed].first) || !valid_vertex(elist[ed].second))
+		return false;
+	    if(ordered && position[elist[ed].first] >= position[elist[ed].second])
+		return false;
+            return 2 * elist.size() <= etable.size();}
+
         // -----
         // valid
         // -----
 
-
         /**
          * Gurantees validity of the grapy values
-	 * assert should be placed in each function that modifies the graph
-	 * these asserts should be turned when not in development
+	 * the adjacency lists, elist and etable must hold the same edges
          */
         bool valid () const {
+	    std::size_t probes;
+	    if(2 * elist.size() > etable.size() && !elist.empty())
+		return false;
+	    if(!vremoved.empty() && vremoved.size() != vlist.size())
+		return false;
+	    vertices_size_type count_removed = 0;
+	    for(std::size_t i = 0; i < vremoved.size(); ++i)
+		if(vremoved[i]) {
+		    ++count_removed;
+		    if(!vlist[i].empty())
+			return false;}
+	    if(count_removed != removed_vertices)
+		return false;
+	    // each adjacency entry must map to a distinct edge
+	    std::vector<char> seen(elist.size(), 0);
 	    vertices_size_type count_edges = 0;
-	    for(unsigned int i = 0; i < vlist.size(); ++i){
+	    for(std::size_t i = 0; i < vlist.size(); ++i){
 		count_edges += vlist[i].size();
-		for(unsigned int j = 0; j < vlist[i].size(); ++j) {
-		    assert(vlist[i][j] >= 0);		
-		    assert((std::size_t)vlist[i][j] < vlist.size());}}
-	    assert(count_edges == elist.size());
-            for(unsigned int i = 0; i < elist.size(); ++i) {
-		assert((std::size_t)elist[i].first < vlist.size());
-		assert((std::size_t)elist[i].second < vlist.size());
-		adjacency_iterator beg = vlist[elist[i].first].begin();
-		adjacency_iterator end = vlist[elist[i].first].end();
-		assert(find(beg, end, elist[i].second) != end);}
+		for(std::size_t j = 0; j < vlist[i].size(); ++j) {
+		    if(!valid_vertex(vlist[i][j]))
+			return false;
+		    std::pair<edge_descriptor, bool> p = probe_edge(i, vlist[i][j], probes);
+		    if(!p.second || seen[p.first])
+			return false;
+		    seen[p.first] = 1;}}
+	    if(count_edges + removed_edges != elist.size())
+		return false;
+	    // each in edge entry must be a distinct live edge into its vertex
+	    if(bidirectional) {
+		if(ilist.size() != vlist.size())
+		    return false;
+		std::vector<char> seen_in(elist.size(), 0);
+		vertices_size_type count_in = 0;
+		for(std::size_t i = 0; i < ilist.size(); ++i) {
+		    count_in += ilist[i].size();
+		    for(std::size_t j = 0; j < ilist[i].size(); ++j) {
+			edge_descriptor ed = ilist[i][j];
+			if((std::size_t)ed >= elist.size() || seen_in[ed] || elist[ed].second != (vertex_descriptor)i)
+			    return false;
+			seen_in[ed] = 1;}}
+		if(count_in != count_edges)
+		    return false;}
+            for(std::size_t i = 0; i < elist.size(); ++i) {
+		if(elist[i].first == null_vertex())
+		    continue;
+		if(!valid_vertex(elist[i].first) || !valid_vertex(elist[i].second))
+		    return false;
+		if(probe_edge(elist[i].first, elist[i].second, probes).first != (edge_descriptor)i)
+		    return false;
+		if(ordered && position[elist[i].first] >= position[elist[i].second])
+		    return false;}
+	    if(ordered) {
+		if(order.size() != vlist.size() || position.size() != vlist.size())
+		    return false;
+		for(std::size_t i = 0; i < order.size(); ++i)
+		    if((std::size_t)order[i] >= vlist.size() || position[order[i]] != i)
+			return false;}
             return true;}
 
     public:
@@ -263,45 +1572,154 @@ class Graph {
 
         /**
          * default destuctor - produces empty graph with no vertices or edges
+	 * @param a the allocator of the rows, a copy goes to every row
          */
-        Graph () {
+        explicit basic_graph (const allocator_type& a = allocator_type()) :
+		alloc(a),
+		bidirectional(false),
+		removed_vertices(0),
+		removed_edges(0),
+		ordered(false) {
             assert(valid());}
 
-        // Default copy, destructor, and copy assignment
-        // Graph  (const Graph<T>&);
-        // ~Graph ();
-        // Graph& operator = (const Graph&);
+        /**
+         * builds a graph with n vertices and a range of edges
+	 *     same result as n calls to add_vertex followed by add_edges
+	 * @param n the number of vertices
+	 * @param b a beginning forward iterator over pairs of vertex_descriptors
+	 * @param e an end forward iterator
+	 * @param a the allocator of the rows, a copy goes to every row
+	 * @throws std::length_error if n vertices or the edges need reserved
+	 *     descriptors
+         */
+	template <typename FI>
+        basic_graph (vertices_size_type n, FI b, FI e, const allocator_type& a = allocator_type()) :
+		alloc(a),
+		vlist(n, row(a)),
+		bidirectional(false),
+		removed_vertices(0),
+		removed_edges(0),
+		ordered(false) {
+	    if(n > descriptor_bound(null_vertex()))
+		throw std::length_error("basic_graph: out of vertex_descriptors");
+	    add_edges(b, e, *this);}
+
+        /**
+	 * a deep copy, its rows use copy_allocator of that's allocator
+	 * @param that a Graph
+         */
+        basic_graph (const basic_graph& that) :
+		alloc(copy_allocator(that.alloc)),
+		elist(that.elist),
+		bidirectional(that.bidirectional),
+		vremoved(that.vremoved),
+		removed_vertices(that.removed_vertices),
+		removed_edges(that.removed_edges),
+		ordered(that.ordered),
+		order(that.order),
+		position(that.position),
+		stats(that.stats),
+		etable(that.etable) {
+	    copy_rows(that.vlist, vlist);
+	    copy_rows(that.ilist, ilist);}
+
+        /**
+	 * becomes a copy of that, with the allocator of the copy
+	 * @param that a Graph
+	 * @return this Graph
+         */
+        basic_graph& operator = (const basic_graph& that) {
+	    if(this != &that) {
+		basic_graph copy(that);
+		std::swap(alloc, copy.alloc);
+		vlist.swap(copy.vlist);
+		elist.swap(copy.elist);
+		std::swap(bidirectional, copy.bidirectional);
+		ilist.swap(copy.ilist);
+		vremoved.swap(copy.vremoved);
+		std::swap(removed_vertices, copy.removed_vertices);
+		std::swap(removed_edges, copy.removed_edges);
+		std::swap(ordered, copy.ordered);
+		order.swap(copy.order);
+		position.swap(copy.position);
+		visited.swap(copy.visited);
+		stats = copy.stats;
+		etable.swap(copy.etable);}
+	    return *this;}
+
+#if __cplusplus >= 201103L
+        // moves keep the rows where they are
+        basic_graph (basic_graph&&) = default;
+        basic_graph& operator = (basic_graph&&) = default;
+#endif
+
+        // Default destructor
+        // ~basic_graph ();
     };
 
+// the Graph of the project, int descriptors, no edge property, rows on the heap
+typedef basic_graph<> Graph;
+
 // ---------
 // has_cycle
 // ---------
 
 /**
- * Helper recursive method for has_cycle
- * @param aip a pair of adjacency iterators,
- * @param v_seen a container of vertex_descriptor, used for marking vertices
+ * Helper method for has_cycle
+ * iterative depth-first traversal with three colors:
+ *     0 - unseen, 1 - on the current path, 2 - finished
+ * every vertex and edge is visited at most once, O(V + E)
  * @param g a graph
- * @return true if a cycle is found in this portion of the graph
+ * @param cycle a vector of vertex_descriptor, filled with the vertices of
+ *     the first cycle found, in path order
+ * @return true if a cycle is found
  */
-template<typename AIP, typename C, typename G>
-bool has_cycle (const AIP& aip, C& v_seen, const G& g) {
-    typename G::adjacency_iterator vb = aip.first;
-    typename G::adjacency_iterator ve = aip.second;
-    while(vb != ve) {
-	typename C::iterator sb = v_seen.begin();
-	typename C::iterator se = v_seen.end();
-	if(std::find(sb, se, *vb) != se)
-	    return true;
-	v_seen.push_back(*vb);
-	if(has_cycle(adjacent_vertices(*vb, g), v_seen, g))
-	    return true;
-	v_seen.pop_back();
-	++vb; }
-    
-    return false;
-}
+template <typename G>
+bool find_cycle (const G& g, std::vector<typename G::vertex_descriptor>& cycle) {
+    typedef typename G::vertex_descriptor  vertex_descriptor;
+    typedef typename G::adjacency_iterator adjacency_iterator;
+    typedef std::pair<adjacency_iterator, adjacency_iterator> range;
 
+    std::vector<char> color(vertex_bound(g), 0);
+    std::vector<vertex_descriptor> path;
+    std::vector<range> frames;
+    algorithm_statistics a("has_cycle");
+
+    std::pair<typename G::vertex_iterator, typename G::vertex_iterator> vi = 
+	vertices(g);
+    typename G::vertex_iterator vb = vi.first;
+    typename G::vertex_iterator ve = vi.second;
+    while(vb != ve) {
+	if(color[*vb] == 0) {
+	    ++a.vertices;
+	    color[*vb] = 1;
+	    path.push_back(*vb);
+	    frames.push_back(adjacent_vertices(*vb, g));
+	    while(!frames.empty()) {
+		a.max_depth = std::max(a.max_depth, frames.size());
+		range& top = frames.back();
+		if(top.first == top.second) {
+		    // every out edge explored, finish the vertex
+		    color[path.back()] = 2;
+		    path.pop_back();
+		    frames.pop_back();
+		    continue;}
+		vertex_descriptor vd = *top.first;
+		++top.first;
+		++a.edges;
+		if(color[vd] == 1) {
+		    // back edge, the cycle is the path from vd to the top
+		    cycle.assign(std::find(path.begin(), path.end(), vd), path.end());
+		    record_algorithm(g, a);
+		    return true;}
+		if(color[vd] == 0) {
+		    ++a.vertices;
+		    color[vd] = 1;
+		    path.push_back(vd);
+		    frames.push_back(adjacent_vertices(vd, g));}}}
+	++vb;}
+    record_algorithm(g, a);
+    return false;}
 
 /**
  * depth-first traversal
@@ -312,19 +1730,26 @@ bool has_cycle (const AIP& aip, C& v_seen, const G& g) {
  */
 template <typename G>
 bool has_cycle (const G& g) {
-    std::pair<typename G::vertex_iterator, typename G::vertex_iterator> vi = 
-	vertices(g);
-    typename G::vertex_iterator vb = vi.first;
-    typename G::vertex_iterator ve = vi.second;
-    
-    std::vector<typename G::vertex_descriptor> v_seen;
-    while(vb != ve) {
-	v_seen.push_back(*vb);
-	if(has_cycle(adjacent_vertices(*vb, g), v_seen, g))
-	    return true;
-	v_seen.pop_back();
-	++vb;}
-    return false;}
+    std::vector<typename G::vertex_descriptor> cycle;
+    return find_cycle(g, cycle);}
+
+/**
+ * depth-first traversal
+ * three colors
+ * checks a directed graph for the presence of cycles and reports one
+ * @param g is a graph
+ * @param x an output iterator, receives the vertices of the first cycle
+ *     found, in path order, each vertex has an edge to the next and the
+ *     last has an edge back to the first
+ * @return true if the graph is cyclic, false otherwise
+ */
+template <typename G, typename OI>
+bool has_cycle (const G& g, OI x) {
+    std::vector<typename G::vertex_descriptor> cycle;
+    if(!find_cycle(g, cycle))
+	return false;
+    std::copy(cycle.begin(), cycle.end(), x);
+    return true;}
 
 // ----------------
 // topological_sort
@@ -348,24 +1773,29 @@ void topological_sort (const G& g, OI x) {
 	return;
 
     // initialize target_list
-    std::vector<int> target_list(num_v);
+    std::vector<int> target_list(vertex_bound(g));
     std::deque<typename G::vertex_descriptor> v_zero;
+    algorithm_statistics a("topological_sort");
     std::pair<typename G::edge_iterator, typename G::edge_iterator> p = edges(g);
     typename G::edge_iterator eb = p.first; 
     typename G::edge_iterator ee = p.second;
     while(eb != ee) {
+	++a.edges;
 	++target_list[target(*eb, g)];
 	++eb; }
     
    //algorithm		
     std::vector<typename G::vertex_descriptor> temp_out;
     // add zeroed vertices
-    for(unsigned int i = 0; i < target_list.size(); ++i) 
-	if(target_list[i] == 0) {
-	    --target_list[i];
- 	    v_zero.push_back(i);} 
+    std::pair<typename G::vertex_iterator, typename G::vertex_iterator> vp = vertices(g);
+    for(; vp.first != vp.second; ++vp.first) 
+	if(target_list[*vp.first] == 0) {
+	    --target_list[*vp.first];
+ 	    v_zero.push_back(*vp.first);} 
 	
     while(!v_zero.empty()) {
+	++a.vertices;
+	a.max_depth = std::max(a.max_depth, v_zero.size());
 	// output next empty
 	typename G::vertex_descriptor vd = v_zero.front();
 	temp_out.push_back(vd);
@@ -377,6 +1807,7 @@ void topological_sort (const G& g, OI x) {
 	typename G::adjacency_iterator ab = ai.first;
 	typename G::adjacency_iterator ae = ai.second;
 	while(ab != ae) {
+	    ++a.edges;
 	    --target_list[*ab];
 	    // add zeroed edges to v_zero
 	    if(target_list[*ab] == 0) {
@@ -384,6 +1815,8 @@ void topological_sort (const G& g, OI x) {
 		v_zero.push_back(*ab);}
 	    ++ab;}}
 	
+	record_algorithm(g, a);
+
 	// move values from temp to output iterator	
 	while(!temp_out.empty()) {
 	    *x = temp_out.back();
@@ -0,0 +1,295 @@
+// ----------------------------
+// projects/graph/MappedGraph.h
+// Copyright (C) 2012
+// Glenn P. Downing
+// ----------------------------
+
+#ifndef MappedGraph_h
+#define MappedGraph_h
+
+// --------
+// includes
+// --------
+
+#include <algorithm> // sort
+#include <cerrno>    // errno, EEXIST, EINTR
+#include <climits>   // INT_MAX
+#include <cstddef>   // size_t
+#include <cstdio>    // remove, rename
+#include <cstring>   // memcmp, memcpy
+#include <sstream>   // ostringstream
+#include <stdexcept> // runtime_error
+#include <string>    // string
+#include <utility>   // pair
+#include <vector>    // vector
+#include <stdint.h>  // uint32_t, uint64_t, int32_t
+#include <fcntl.h>    // open, O_CREAT, O_EXCL, O_RDONLY, O_WRONLY
+#include <sys/mman.h> // mmap, munmap
+#include <sys/stat.h> // fstat
+#include <unistd.h>   // close, fsync, getpid, write
+
+#include "CsrView.h"
+#include "Graph.h" // vertex_bound
+
+// ------------
+// graph_header
+// ------------
+
+/**
+ * the first bytes of a saved graph, followed by num_vertices + 1 uint64_t
+ *     row offsets and then num_edges int32_t targets, all native endian
+ * rows are sorted, so edges are numbered in (source, target) order
+ * the checksum is 64 bit FNV-1a over the offsets and targets
+ */
+struct graph_header {
+    char     magic[4];
+    uint32_t version;
+    uint64_t num_vertices;
+    uint64_t num_edges;
+    uint64_t checksum;};
+
+const char     graph_magic[4] = {'G', 'R', 'P', 'H'};
+const uint32_t graph_version  = 1;
+
+// --------
+// checksum
+// --------
+
+/**
+ * 64 bit FNV-1a, continued from h
+ * @param h the checksum so far
+ * @param p the bytes
+ * @param n the number of bytes
+ * @return the checksum including p
+ */
+inline uint64_t checksum (uint64_t h, const void* p, std::size_t n) {
+    const unsigned char* b = static_cast<const unsigned char*>(p);
+    for(std::size_t i = 0; i != n; ++i) {
+	h ^= b[i];
+	h *= 1099511628211ull;}
+    return h;}
+
+const uint64_t checksum_basis = 14695981039346656037ull;
+
+// ---------
+// write_all
+// ---------
+
+/**
+ * writes n bytes to a file descriptor, resuming short writes
+ * @param fd the file descriptor
+ * @param p the bytes
+ * @param n the number of bytes
+ * @return true if all n bytes were written
+ */
+inline bool write_all (int fd, const void* p, std::size_t n) {
+    const char* b = static_cast<const char*>(p);
+    while(n != 0) {
+	const ssize_t w = write(fd, b, n);
+	if(w == -1 && errno == EINTR)
+	    continue;
+	if(w <= 0)
+	    return false;
+	b += w;
+	n -= w;}
+    return true;}
+
+// ----
+// save
+// ----
+
+/**
+ * writes a graph in the MappedGraph format
+ * the graph goes to a temporary file next to path, unique to the call,
+ *     that is synced and then renamed over it, so a MappedGraph still
+ *     mapping the old file keeps reading the old contents
+ * @param g a graph whose vertex_descriptors are 0 .. vertex_bound(g) - 1,
+ *     removed vertices are written as vertices without edges
+ * @param path the file to create or replace
+ * @throws std::runtime_error if the file cannot be written, or if g has
+ *     more than INT_MAX vertices or edges, the format stores int32_t
+ *     targets and MappedGraph's descriptors are ints
+ */
+template <typename G>
+void save (const G& g, const char* path) {
+    typedef typename G::adjacency_iterator adjacency_iterator;
+    const std::size_t num_v = vertex_bound(g);
+    if(num_v > INT_MAX || num_edges(g) > INT_MAX)
+	throw std::runtime_error(std::string("save: too large for int descriptors ") + path);
+    std::vector<uint64_t> offsets(1, 0);
+    std::vector<int32_t>  targets;
+    offsets.reserve(num_v + 1);
+    targets.reserve(num_edges(g));
+    for(std::size_t v = 0; v != num_v; ++v) {
+	std::pair<adjacency_iterator, adjacency_iterator> p = adjacent_vertices(vertex(v, g), g);
+	for(; p.first != p.second; ++p.first)
+	    targets.push_back(*p.first);
+	std::sort(targets.begin() + offsets.back(), targets.end());
+	offsets.push_back(targets.size());}
+
+    graph_header h;
+    std::memcpy(h.magic, graph_magic, sizeof(h.magic));
+    h.version      = graph_version;
+    h.num_vertices = num_v;
+    h.num_edges    = targets.size();
+    h.checksum     = checksum(checksum(checksum_basis,
+	    &offsets[0], offsets.size() * sizeof(uint64_t)),
+	    targets.empty() ? 0 : &targets[0], targets.size() * sizeof(int32_t));
+
+    // a fresh name per call, O_EXCL retries if a concurrent save took it
+    std::string tmp;
+    int fd = -1;
+    for(static unsigned long sequence = 0; fd == -1; ) {
+	std::ostringstream temporary;
+	temporary << path << ".tmp." << getpid() << "." << ++sequence;
+	tmp = temporary.str();
+	fd = open(tmp.c_str(), O_WRONLY | O_CREAT | O_EXCL, 0666);
+	if(fd == -1 && errno != EEXIST)
+	    throw std::runtime_error(std::string("save: cannot write ") + path);}
+    // fsync before rename, so a crash cannot leave path naming a short file
+    bool written = write_all(fd, &h, sizeof(h)) &&
+	write_all(fd, &offsets[0], offsets.size() * sizeof(uint64_t)) &&
+	write_all(fd, targets.empty() ? 0 : &targets[0], targets.size() * sizeof(int32_t)) &&
+	fsync(fd) == 0;
+    written = close(fd) == 0 && written;
+    if(!written || std::rename(tmp.c_str(), path) != 0) {
+	std::remove(tmp.c_str());
+	throw std::runtime_error(std::string("save: cannot write ") + path);}}
+
+// -----------
+// MappedGraph
+// -----------
+
+/**
+ * a read-only graph served straight from a file written by save()
+ * the file is mapped, not copied, so opening costs O(1) without verify
+ * its interface is csr_view's
+ */
+class MappedGraph : public csr_view<MappedGraph, uint64_t, int32_t> {
+    private:
+        // ----
+        // data
+        // ----
+
+	//the mapping and views into it
+	void*               base;
+	std::size_t         length;
+	const graph_header* header;
+	const uint64_t*     offsets;
+	const int32_t*      targets;
+
+	// ------------------
+	// csr_view interface
+	// ------------------
+
+	friend class csr_view<MappedGraph, uint64_t, int32_t>;
+
+	const uint64_t* csr_offsets () const {
+	    return offsets;}
+
+	const int32_t* csr_targets () const {
+	    return targets;}
+
+	std::size_t csr_vertices () const {
+	    return header->num_vertices;}
+
+	std::size_t csr_edges () const {
+	    return header->num_edges;}
+
+	// ----
+	// fail
+	// ----
+
+	/**
+	 * helper method that releases the mapping and reports a bad file
+	 * @throws std::runtime_error always
+	 */
+	void fail (const char* path, const char* why) {
+	    if(base != MAP_FAILED)
+		munmap(base, length);
+	    throw std::runtime_error(std::string("MappedGraph: ") + path + ": " + why);}
+
+        // -----
+        // valid
+        // -----
+
+        /**
+         * O(V + E) audit of the offsets and targets
+         */
+        bool valid () const {
+	    const uint64_t num_v = header->num_vertices;
+	    if(offsets[0] != 0 || offsets[num_v] != header->num_edges)
+		return false;
+	    for(uint64_t v = 0; v != num_v; ++v)
+		if(offsets[v] > offsets[v + 1])
+		    return false;
+	    for(uint64_t i = 0; i != header->num_edges; ++i)
+		if(targets[i] < 0 || (uint64_t)targets[i] >= num_v)
+		    return false;
+            return true;}
+
+	// MappedGraph owns its mapping, so it is not copyable
+	MappedGraph (const MappedGraph&);
+	MappedGraph& operator = (const MappedGraph&);
+
+    public:
+        // ------------
+        // constructors
+        // ------------
+
+        /**
+         * maps a file written by save()
+	 * @param path the file
+	 * @param verify if true, the checksum and every offset and target
+	 *     are checked, O(V + E), otherwise only the header and size are
+	 * @throws std::runtime_error if the file cannot be mapped, has the
+	 *     wrong magic, version or size, or fails verification
+         */
+        explicit MappedGraph (const char* path, bool verify = true) :
+		base(MAP_FAILED),
+		length(0) {
+	    int fd = open(path, O_RDONLY);
+	    if(fd == -1)
+		fail(path, "cannot open");
+	    struct stat st;
+	    if(fstat(fd, &st) == -1 || (std::size_t)st.st_size < sizeof(graph_header)) {
+		close(fd);
+		fail(path, "too short");}
+	    length = st.st_size;
+	    base   = mmap(0, length, PROT_READ, MAP_SHARED, fd, 0);
+	    close(fd);
+	    if(base == MAP_FAILED)
+		fail(path, "cannot map");
+
+	    header = static_cast<const graph_header*>(base);
+	    if(std::memcmp(header->magic, graph_magic, sizeof(graph_magic)) != 0)
+		fail(path, "not a saved graph");
+	    if(header->version != graph_version)
+		fail(path, "unsupported version");
+	    // bound the counts before multiplying, descriptors are ints
+	    const uint64_t room = length - sizeof(graph_header);
+	    if(header->num_vertices > INT_MAX || header->num_vertices >= room / sizeof(uint64_t))
+		fail(path, "wrong size");
+	    if(header->num_edges > INT_MAX || header->num_edges > room / sizeof(int32_t))
+		fail(path, "wrong size");
+	    const uint64_t offsets_size = (header->num_vertices + 1) * sizeof(uint64_t);
+	    const uint64_t targets_size = header->num_edges * sizeof(int32_t);
+	    if(length != sizeof(graph_header) + offsets_size + targets_size)
+		fail(path, "wrong size");
+	    offsets = reinterpret_cast<const uint64_t*>(header + 1);
+	    targets = reinterpret_cast<const int32_t*>(offsets + header->num_vertices + 1);
+
+	    if(verify) {
+		if(checksum(checksum(checksum_basis, offsets, offsets_size), targets, targets_size) != header->checksum)
+		    fail(path, "bad checksum");
+		if(!valid())
+		    fail(path, "bad offsets or targets");}}
+
+        /**
+         * releases the mapping
+         */
+        ~MappedGraph () {
+	    munmap(base, length);}
+    };
+
+#endif // MappedGraph_h
@@ -0,0 +1,219 @@
+// ----------------------------------------
+// projects/graph/ParallelTopologicalSort.h
+// Copyright (C) 2012
+// Glenn P. Downing
+// ----------------------------------------
+
+#ifndef ParallelTopologicalSort_h
+#define ParallelTopologicalSort_h
+
+#if __cplusplus < 201103L
+#error "ParallelTopologicalSort.h requires C++11 threads and atomics"
+#endif
+
+// --------
+// includes
+// --------
+
+#include <algorithm> // copy, inplace_merge, max, min, sort
+#include <atomic>    // atomic
+#include <cstddef>   // size_t
+#include <iterator>  // distance
+#include <thread>    // thread
+#include <utility>   // pair
+#include <vector>    // vector
+#include "boost/config.hpp"          // BOOST_SYMBOL_VISIBLE
+#include "boost/graph/exception.hpp" // not_a_dag
+
+#include "Graph.h" // vertex_bound
+
+// -----------------
+// topological_grain
+// -----------------
+
+// the fewest items each thread is given, smaller wavefronts run serially
+const std::size_t topological_grain = 2048;
+
+// ------------
+// parallel_for
+// ------------
+
+/**
+ * Helper method for topological_levels
+ * splits [0, n) into one contiguous chunk per thread and runs f on each
+ *     runs f on the calling thread alone if n is too small to share
+ * @param n the number of items
+ * @param threads the most threads to use
+ * @param f called as f(begin, end, chunk) with chunk in [0, threads)
+ * @return the number of chunks used
+ */
+template <typename F>
+unsigned parallel_for (std::size_t n, unsigned threads, F f) {
+    unsigned chunks = std::min<std::size_t>(threads, n / topological_grain);
+    if(chunks <= 1) {
+        f(std::size_t(0), n, 0u);
+        return 1;}
+    std::vector<std::thread> pool;
+    for(unsigned c = 1; c < chunks; ++c)
+        pool.push_back(std::thread(f, n * c / chunks, n * (c + 1) / chunks, c));
+    f(std::size_t(0), n / chunks, 0u);
+    for(unsigned c = 0; c < pool.size(); ++c)
+        pool[c].join();
+    return chunks;}
+
+// -------------
+// parallel_each
+// -------------
+
+/**
+ * Helper method for merge_runs
+ * runs f(0) .. f(n - 1) on n threads, f(0) on the calling thread
+ * @param n the number of calls
+ * @param f called as f(i) with i in [0, n)
+ */
+template <typename F>
+void parallel_each (unsigned n, F f) {
+    std::vector<std::thread> pool;
+    for(unsigned i = 1; i < n; ++i)
+        pool.push_back(std::thread(f, i));
+    if(n != 0)
+        f(0u);
+    for(unsigned i = 0; i < pool.size(); ++i)
+        pool[i].join();}
+
+// ----------
+// merge_runs
+// ----------
+
+/**
+ * Helper method for topological_levels
+ * joins the sorted runs of the chunks into one sorted level
+ *     each run is copied into place on its own thread, then neighboring
+ *     runs are merged pairwise, the merges of each round in parallel
+ * @param runs the runs, one per chunk, left empty
+ * @param chunks the number of runs used
+ * @param out replaced with the merged runs
+ */
+template <typename T>
+void merge_runs (std::vector< std::vector<T> >& runs, unsigned chunks, std::vector<T>& out) {
+    if(chunks == 1) {
+        out.clear();
+        out.swap(runs[0]);
+        return;}
+    std::vector<std::size_t> offset(chunks + 1, 0);
+    for(unsigned c = 0; c < chunks; ++c)
+        offset[c + 1] = offset[c] + runs[c].size();
+    out.resize(offset[chunks]);
+    parallel_each(chunks, [&] (unsigned c) {
+        std::copy(runs[c].begin(), runs[c].end(), out.begin() + offset[c]);
+        runs[c].clear();});
+    for(unsigned width = 1; width < chunks; width *= 2)
+        parallel_each((chunks + 2 * width - 1) / (2 * width), [&] (unsigned p) {
+            const unsigned l = 2 * width * p;
+            const unsigned m = std::min(l + width, chunks);
+            const unsigned r = std::min(l + 2 * width, chunks);
+            std::inplace_merge(out.begin() + offset[l], out.begin() + offset[m], out.begin() + offset[r]);});}
+
+// ------------------
+// topological_levels
+// ------------------
+
+/**
+ * Kahn's algorithm, one wavefront at a time
+ * in-degrees are counted in parallel, then every vertex of a wavefront
+ *     is expanded in parallel with atomic decrements, and the vertices
+ *     whose in-degree reaches zero form the next wavefront
+ * each thread sorts what it found, so only a merge of the sorted runs
+ *     stands between two wavefronts
+ * levels[0] holds the vertices with no in edges, every edge goes from a
+ *     lower level to a higher one, each level is sorted
+ * vertex descriptors must be indices below vertex_bound(g)
+ * @param g a graph
+ * @param levels a vector of levels, replaced with the wavefronts
+ * @param threads the most threads to use, 0 for one per core
+ * @throws Boost's not_a_dag exception if the graph has a cycle
+ */
+template <typename G>
+void topological_levels (const G& g, std::vector< std::vector<typename G::vertex_descriptor> >& levels, unsigned threads = 0) {
+    typedef typename G::vertex_descriptor  vertex_descriptor;
+    typedef typename G::adjacency_iterator adjacency_iterator;
+    typedef std::vector<vertex_descriptor> level;
+
+    if(threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    levels.clear();
+    const std::size_t bound = vertex_bound(g);
+    std::vector< std::atomic<int> > in_degree(bound);
+    std::vector<level> found(threads);
+
+    // count in-degrees
+    parallel_for(bound, threads, [&] (std::size_t b, std::size_t e, unsigned) {
+        for(std::size_t i = b; i != e; ++i) {
+            std::pair<adjacency_iterator, adjacency_iterator> ai = adjacent_vertices(vertex(i, g), g);
+            for(; ai.first != ai.second; ++ai.first)
+                in_degree[*ai.first].fetch_add(1, std::memory_order_relaxed);}});
+
+    // the first wavefront, from vertices() so removed vertices are skipped
+    typename G::vertex_iterator vb = vertices(g).first;
+    typename G::vertex_iterator ve = vertices(g).second;
+    for(; vb != ve; ++vb)
+        if(in_degree[*vb].load(std::memory_order_relaxed) == 0)
+            found[0].push_back(*vb);
+    unsigned chunks = 1;
+
+    std::size_t emitted = 0;
+    algorithm_statistics a("topological_levels");
+    while(true) {
+        // gather the zeroed vertices of every chunk
+        level next;
+        merge_runs(found, chunks, next);
+        if(next.empty())
+            break;
+        emitted += next.size();
+        a.max_depth = std::max(a.max_depth, next.size());
+        levels.push_back(level());
+        levels.back().swap(next);
+
+        // "cut" the out edges of the wavefront
+        const level& front = levels.back();
+        chunks = parallel_for(front.size(), threads, [&] (std::size_t b, std::size_t e, unsigned c) {
+            for(std::size_t i = b; i != e; ++i) {
+                std::pair<adjacency_iterator, adjacency_iterator> ai = adjacent_vertices(front[i], g);
+                for(; ai.first != ai.second; ++ai.first)
+                    if(in_degree[*ai.first].fetch_sub(1, std::memory_order_acq_rel) == 1)
+                        found[c].push_back(*ai.first);}
+            std::sort(found[c].begin(), found[c].end());});}
+
+    // every emitted vertex had each of its out edges cut once
+    a.vertices = emitted;
+    for(std::size_t l = 0; l < levels.size(); ++l)
+        for(std::size_t i = 0; i < levels[l].size(); ++i)
+            a.edges += std::distance(adjacent_vertices(levels[l][i], g).first, adjacent_vertices(levels[l][i], g).second);
+    record_algorithm(g, a);
+
+    // vertices on or behind a cycle never reach in-degree zero
+    if(emitted != num_vertices(g))
+        throw boost::not_a_dag();}
+
+// -------------------------
+// parallel_topological_sort
+// -------------------------
+
+/**
+ * a drop in for topological_sort built on topological_levels
+ * like topological_sort, vertices are written in reverse topological
+ *     order, every vertex after the vertices it has edges to
+ * @param g a graph
+ * @param x an output iterator
+ * @param threads the most threads to use, 0 for one per core
+ * @throws Boost's not_a_dag exception if the graph has a cycle
+ */
+template <typename G, typename OI>
+void parallel_topological_sort (const G& g, OI x, unsigned threads = 0) {
+    std::vector< std::vector<typename G::vertex_descriptor> > levels;
+    topological_levels(g, levels, threads);
+    while(!levels.empty()) {
+        x = std::copy(levels.back().begin(), levels.back().end(), x);
+        levels.pop_back();}}
+
+#endif // ParallelTopologicalSort_h
@@ -16,18 +16,28 @@ To test the program:
     ...
     adjacency_list.hpp
     ...
-    % g++ -ansi -pedantic -I/public/linux/include/boost-1_44 -lcppunit -ldl -Wall TestGraph.c++ -o TestGraph.app
+    % g++ -std=c++11 -pedantic -pthread -I/public/linux/include/boost-1_44 -lcppunit -ldl -Wall TestGraph.c++ -o TestGraph.app
     % valgrind TestGraph.app >& TestGraph.c++.out
+Add -DGRAPH_STATS=1 to test the counters as well.
 */
 
 // --------
 // includes
 // --------
 
+#include <algorithm> // find, reverse
+#include <cstdio>   // remove
+#include <cstring>  // memcpy
+#include <fstream>  // fstream
 #include <iostream> // cout, endl
-#include <iterator> // ostream_iterator
+#include <iterator> // back_inserter, ostream_iterator
 #include <sstream>  // ostringstream
+#include <stdint.h> // uint16_t, uint32_t, uint64_t
+#include <stdexcept> // length_error, runtime_error
+#include <string>   // string
+#include <thread>   // thread
 #include <utility>  // pair
+#include <vector>   // vector
 
 #include "boost/graph/adjacency_list.hpp"  // adjacency_list
 #include "boost/graph/topological_sort.hpp"// topological_sort
@@ -37,7 +47,11 @@ To test the program:
 #include "cppunit/TestSuite.h"               // TestSuite
 #include "cppunit/TextTestRunner.h"          // TestRunner
 
+#include "Arena.h"
 #include "Graph.h"
+#include "CsrGraph.h"
+#include "MappedGraph.h"
+#include "ParallelTopologicalSort.h"
 
 // ---------
 // TestGraph
@@ -200,6 +214,24 @@ struct TestGraph : CppUnit::TestFixture {
         std::pair<edge_descriptor, bool> p = edge(vdB, vdA, g);
         CPPUNIT_ASSERT(p.second == false);}
 
+    void test_edge_4 () {
+	graph_type test;
+	for(int i = 0; i < 40; ++i)
+	    add_vertex(test);
+	for(int i = 0; i < 40; ++i)
+	    for(int j = 1; j <= 5; ++j)
+		CPPUNIT_ASSERT(add_edge(i, (i * 7 + j) % 40, test).second);
+	CPPUNIT_ASSERT(num_edges(test) == 200);
+	for(int i = 0; i < 40; ++i)
+	    for(int j = 1; j <= 5; ++j) {
+		std::pair<edge_descriptor, bool> p = edge(i, (i * 7 + j) % 40, test);
+		CPPUNIT_ASSERT(p.second == true);
+		CPPUNIT_ASSERT(source(p.first, test) == (vertex_descriptor)i);
+		CPPUNIT_ASSERT(target(p.first, test) == (vertex_descriptor)((i * 7 + j) % 40));
+		CPPUNIT_ASSERT(add_edge(i, (i * 7 + j) % 40, test).second == false);}
+	CPPUNIT_ASSERT(num_edges(test) == 200);
+	CPPUNIT_ASSERT(edge(0, 0, test).second == false);}
+
 
     // ----------
     // test_edges
@@ -379,6 +411,46 @@ struct TestGraph : CppUnit::TestFixture {
         CPPUNIT_ASSERT(has_cycle(g));}
 
 
+    void test_has_cycle_4 () {
+	std::ostringstream out;
+	CPPUNIT_ASSERT(has_cycle(g, std::ostream_iterator<vertex_descriptor>(out, " ")));
+	CPPUNIT_ASSERT(out.str() == "3 5 ");}
+
+    void test_has_cycle_5 () {
+	// a ladder of 40 diamonds, 2^40 paths from the first to the last vertex
+	graph_type test;
+	vertex_descriptor top = add_vertex(test);
+	for(int i = 0; i < 40; ++i) {
+	    vertex_descriptor left   = add_vertex(test);
+	    vertex_descriptor right  = add_vertex(test);
+	    vertex_descriptor bottom = add_vertex(test);
+	    add_edge(top, left, test);
+	    add_edge(top, right, test);
+	    add_edge(left, bottom, test);
+	    add_edge(right, bottom, test);
+	    top = bottom;}
+	std::ostringstream out;
+	CPPUNIT_ASSERT(!has_cycle(test));
+	CPPUNIT_ASSERT(!has_cycle(test, std::ostream_iterator<vertex_descriptor>(out, " ")));
+	CPPUNIT_ASSERT(out.str() == "");}
+
+    void test_has_cycle_6 () {
+	// a chain long enough to overflow a recursive traversal
+	graph_type test;
+	vertex_descriptor first = add_vertex(test);
+	vertex_descriptor last  = first;
+	for(int i = 0; i < 200000; ++i) {
+	    vertex_descriptor next = add_vertex(test);
+	    add_edge(last, next, test);
+	    last = next;}
+	CPPUNIT_ASSERT(!has_cycle(test));
+	add_edge(last, first, test);
+	std::vector<vertex_descriptor> cycle;
+	CPPUNIT_ASSERT(has_cycle(test, std::back_inserter(cycle)));
+	CPPUNIT_ASSERT(cycle.size() == 200001);
+	CPPUNIT_ASSERT(cycle.front() == first);
+	CPPUNIT_ASSERT(cycle.back()  == last);}
+
     // ---------------------
     // test_topological_sort
     // ---------------------
@@ -447,6 +519,86 @@ struct TestGraph : CppUnit::TestFixture {
 	    CPPUNIT_ASSERT(true);}}
 
 
+    // ------------------------------
+    // test_parallel_topological_sort
+    // ------------------------------
+
+    // true if every edge of test goes from an earlier to a later position
+    static bool respects_edges (const graph_type& test, const std::vector<vertex_descriptor>& order) {
+        std::vector<int> position(num_vertices(test), -1);
+        for(unsigned int i = 0; i < order.size(); ++i)
+            position[order[i]] = i;
+        if(std::find(position.begin(), position.end(), -1) != position.end())
+            return false;
+        std::pair<edge_iterator, edge_iterator> p = edges(test);
+        for(; p.first != p.second; ++p.first)
+            if(position[source(*p.first, test)] >= position[target(*p.first, test)])
+                return false;
+        return true;}
+
+    void test_parallel_topological_sort_1 () {
+        graph_type test;
+        for(int i = 0; i < 5; ++i)
+            add_vertex(test);
+        add_edge(vdA, vdD, test);
+        add_edge(vdA, vdC, test);
+        add_edge(vdC, vdE, test);
+        add_edge(vdC, vdB, test);
+        add_edge(vdE, vdD, test);
+        add_edge(vdE, vdB, test);
+        std::vector< std::vector<vertex_descriptor> > levels;
+        topological_levels(test, levels, 4);
+        CPPUNIT_ASSERT(levels.size() == 4);
+        CPPUNIT_ASSERT(levels[0] == std::vector<vertex_descriptor>(1, vdA));
+        CPPUNIT_ASSERT(levels[1] == std::vector<vertex_descriptor>(1, vdC));
+        CPPUNIT_ASSERT(levels[2] == std::vector<vertex_descriptor>(1, vdE));
+        CPPUNIT_ASSERT(levels[3].size() == 2);
+        std::ostringstream out;
+        parallel_topological_sort(test, std::ostream_iterator<vertex_descriptor>(out, " "), 4);
+        CPPUNIT_ASSERT(out.str() == "1 3 4 2 0 ");}
+
+    void test_parallel_topological_sort_2 () {
+        // 6 layers of 5000 vertices, each with edges to 3 in the next layer
+        graph_type test;
+        const int width = 5000;
+        for(int i = 0; i < 6 * width; ++i)
+            add_vertex(test);
+        for(int layer = 0; layer < 5; ++layer)
+            for(int i = 0; i < width; ++i)
+                for(int j = 0; j < 3; ++j)
+                    add_edge(layer * width + i, (layer + 1) * width + (i * 7 + j * 1031) % width, test);
+        std::vector< std::vector<vertex_descriptor> > levels;
+        topological_levels(test, levels, 4);
+        CPPUNIT_ASSERT(levels.size() == 6);
+        CPPUNIT_ASSERT(levels[5].size() == (std::size_t)width);
+        std::vector<vertex_descriptor> order;
+        parallel_topological_sort(test, std::back_inserter(order), 4);
+        std::reverse(order.begin(), order.end());
+        CPPUNIT_ASSERT(respects_edges(test, order));}
+
+    void test_parallel_topological_sort_4 () {
+        // a wide wavefront cut by 3 threads, each finding scattered vertices
+        graph_type test;
+        const int width = 7000;
+        for(int i = 0; i < 2 * width; ++i)
+            add_vertex(test);
+        for(int i = 0; i < width; ++i)
+            add_edge(i, width + (i * 4001) % width, test);
+        std::vector< std::vector<vertex_descriptor> > levels;
+        topological_levels(test, levels, 3);
+        CPPUNIT_ASSERT(levels.size() == 2);
+        CPPUNIT_ASSERT(levels[1].size() == (std::size_t)width);
+        for(int i = 0; i < width; ++i)
+            CPPUNIT_ASSERT(levels[1][i] == (vertex_descriptor)(width + i));}
+
+    void test_parallel_topological_sort_3 () {
+        try {
+            std::vector<vertex_descriptor> order;
+            parallel_topological_sort(g, std::back_inserter(order), 4);
+            CPPUNIT_ASSERT(false);}
+        catch(boost::not_a_dag e) {
+            CPPUNIT_ASSERT(true);}}
+
     // -----
     // suite
     // -----
@@ -461,6 +613,7 @@ struct TestGraph : CppUnit::TestFixture {
     CPPUNIT_TEST(test_edge_1);
     CPPUNIT_TEST(test_edge_2);
     CPPUNIT_TEST(test_edge_3);
+    CPPUNIT_TEST(test_edge_4);
     CPPUNIT_TEST(test_edges_1);
     CPPUNIT_TEST(test_edges_2);
     CPPUNIT_TEST(test_edges_3);
@@ -485,9 +638,1240 @@ struct TestGraph : CppUnit::TestFixture {
     CPPUNIT_TEST(test_has_cycle_1);
     CPPUNIT_TEST(test_has_cycle_2);
     CPPUNIT_TEST(test_has_cycle_3);
+    CPPUNIT_TEST(test_has_cycle_4);
+    CPPUNIT_TEST(test_has_cycle_5);
+    CPPUNIT_TEST(test_has_cycle_6);
     CPPUNIT_TEST(test_topological_sort_1);
     CPPUNIT_TEST(test_topological_sort_2);
     CPPUNIT_TEST(test_topological_sort_3);
+    CPPUNIT_TEST(test_parallel_topological_sort_1);
+    CPPUNIT_TEST(test_parallel_topological_sort_2);
+    CPPUNIT_TEST(test_parallel_topological_sort_3);
+    CPPUNIT_TEST(test_parallel_topological_sort_4);
+    CPPUNIT_TEST_SUITE_END();};
+
+
+// -------------------
+// TestGraphExtensions
+// -------------------
+
+// functions of Graph that boost's adjacency_list does not share
+struct TestGraphExtensions : CppUnit::TestFixture {
+    // --------
+    // typedefs
+    // --------
+
+    typedef Graph                                   graph_type;
+
+    typedef graph_type::vertex_descriptor           vertex_descriptor;
+    typedef graph_type::edge_descriptor             edge_descriptor;
+
+    // -------------
+    // test_validate
+    // -------------
+
+    void test_validate_1 () {
+        graph_type empty;
+        CPPUNIT_ASSERT(validate(empty));}
+
+    void test_validate_2 () {
+        graph_type test;
+        for(int i = 0; i < 100; ++i)
+            add_vertex(test);
+        for(int i = 0; i < 100; ++i)
+            for(int j = 0; j < 10; ++j)
+                add_edge(i, (i + j * j) % 100, test);
+        CPPUNIT_ASSERT(validate(test));}
+
+    // --------------
+    // test_add_edges
+    // --------------
+
+    static std::vector< std::pair<vertex_descriptor, vertex_descriptor> > batch () {
+        std::vector< std::pair<vertex_descriptor, vertex_descriptor> > input;
+        for(int i = 0; i < 300; ++i)
+            input.push_back(std::make_pair((i * 13) % 50, (i * 29) % 50));
+        return input;}
+
+    void test_add_edges_1 () {
+        std::vector< std::pair<vertex_descriptor, vertex_descriptor> > input = batch();
+        graph_type one;
+        graph_type bulk;
+        for(int i = 0; i < 50; ++i) {
+            add_vertex(one);
+            add_vertex(bulk);}
+        add_edge(3, 9, one);
+        add_edge(3, 9, bulk);
+        for(unsigned int i = 0; i < input.size(); ++i)
+            add_edge(input[i].first, input[i].second, one);
+        CPPUNIT_ASSERT(add_edges(input.begin(), input.end(), bulk) == num_edges(one) - 1);
+        CPPUNIT_ASSERT(num_edges(bulk) == num_edges(one));
+        for(unsigned int i = 0; i < num_edges(one); ++i) {
+            CPPUNIT_ASSERT(source(i, bulk) == source(i, one));
+            CPPUNIT_ASSERT(target(i, bulk) == target(i, one));}
+        for(int v = 0; v < 50; ++v)
+            CPPUNIT_ASSERT(std::equal(adjacent_vertices(v, one).first, adjacent_vertices(v, one).second,
+                                      adjacent_vertices(v, bulk).first));
+        CPPUNIT_ASSERT(validate(bulk));}
+
+    void test_add_edges_2 () {
+        std::vector< std::pair<vertex_descriptor, vertex_descriptor> > input = batch();
+        graph_type test(50, input.begin(), input.end());
+        CPPUNIT_ASSERT(num_vertices(test) == 50);
+        CPPUNIT_ASSERT(std::distance(vertices(test).first, vertices(test).second) == 50);
+        CPPUNIT_ASSERT(edge(input[0].first, input[0].second, test).first == 0);
+        CPPUNIT_ASSERT(add_edges(input.begin(), input.end(), test) == 0);
+        CPPUNIT_ASSERT(validate(test));}
+
+    void test_add_edges_3 () {
+        std::vector< std::pair<vertex_descriptor, vertex_descriptor> > none;
+        graph_type test(3, none.begin(), none.end());
+        CPPUNIT_ASSERT(num_vertices(test) == 3);
+        CPPUNIT_ASSERT(num_edges(test) == 0);
+        CPPUNIT_ASSERT(validate(test));}
+
+    void test_add_edges_4 () {
+        // many small batches build the same graph as one add_edge at a time
+        std::vector< std::pair<vertex_descriptor, vertex_descriptor> > input = batch();
+        graph_type one;
+        graph_type chunked;
+        for(int i = 0; i < 50; ++i) {
+            add_vertex(one);
+            add_vertex(chunked);}
+        for(unsigned int i = 0; i < input.size(); ++i)
+            add_edge(input[i].first, input[i].second, one);
+        for(unsigned int i = 0; i < input.size(); i += 7)
+            add_edges(input.begin() + i, input.begin() + std::min<std::size_t>(i + 7, input.size()), chunked);
+        CPPUNIT_ASSERT(num_edges(chunked) == num_edges(one));
+        for(int v = 0; v < 50; ++v)
+            CPPUNIT_ASSERT(std::equal(adjacent_vertices(v, one).first, adjacent_vertices(v, one).second,
+                                      adjacent_vertices(v, chunked).first));
+        CPPUNIT_ASSERT(validate(chunked));}
+
+    // ------------
+    // test_reserve
+    // ------------
+
+    void test_reserve_1 () {
+        graph_type test;
+        reserve_vertices(10, test);
+        reserve_edges(100, test);
+        CPPUNIT_ASSERT(num_vertices(test) == 0);
+        CPPUNIT_ASSERT(num_edges(test) == 0);
+        for(int i = 0; i < 10; ++i)
+            add_vertex(test);
+        for(int i = 0; i < 10; ++i)
+            for(int j = 0; j < 10; ++j)
+                add_edge(i, j, test);
+        reserve_edges(5, test);
+        CPPUNIT_ASSERT(num_edges(test) == 100);
+        CPPUNIT_ASSERT(edge(9, 9, test).first == 99);
+        CPPUNIT_ASSERT(validate(test));}
+
+    // ---------------------------
+    // test_keep_topological_order
+    // ---------------------------
+
+    void test_keep_topological_order_1 () {
+        graph_type test;
+        for(int i = 0; i < 5; ++i)
+            add_vertex(test);
+        add_edge(0, 3, test);
+        add_edge(0, 2, test);
+        add_edge(2, 4, test);
+        keep_topological_order(test);
+        add_edge(2, 1, test);
+        add_edge(4, 3, test);
+        add_edge(4, 1, test);
+        std::vector<vertex_descriptor> order;
+        topological_sort(test, std::back_inserter(order));
+        CPPUNIT_ASSERT(order.size() == 5);
+        std::vector<int> position(5);
+        for(int i = 0; i < 5; ++i)
+            position[order[i]] = i;
+        for(int ed = 0; ed < 6; ++ed)
+            CPPUNIT_ASSERT(position[source(ed, test)] > position[target(ed, test)]);
+        CPPUNIT_ASSERT(validate(test));}
+
+    void test_keep_topological_order_2 () {
+        // every edge goes against the current order
+        graph_type test;
+        keep_topological_order(test);
+        for(int i = 0; i < 200; ++i)
+            add_vertex(test);
+        for(int i = 199; i > 0; --i)
+            add_edge(i, i - 1, test);
+        for(int i = 0; i < 100; ++i)
+            add_edge(199, i, test);
+        CPPUNIT_ASSERT(validate(test));
+        std::vector<vertex_descriptor> order;
+        topological_sort(test, std::back_inserter(order));
+        for(int i = 0; i < 200; ++i)
+            CPPUNIT_ASSERT(order[i] == i);}
+
+    void test_keep_topological_order_3 () {
+        graph_type test;
+        for(int i = 0; i < 4; ++i)
+            add_vertex(test);
+        add_edge(0, 1, test);
+        add_edge(1, 2, test);
+        add_edge(2, 3, test);
+        keep_topological_order(test);
+        try {
+            add_edge(3, 0, test);
+            CPPUNIT_ASSERT(false);}
+        catch(boost::not_a_dag e) {
+            CPPUNIT_ASSERT(true);}
+        try {
+            add_edge(2, 2, test);
+            CPPUNIT_ASSERT(false);}
+        catch(boost::not_a_dag e) {
+            CPPUNIT_ASSERT(true);}
+        CPPUNIT_ASSERT(num_edges(test) == 3);
+        CPPUNIT_ASSERT(!edge(3, 0, test).second);
+        CPPUNIT_ASSERT(add_edge(0, 3, test).second);
+        CPPUNIT_ASSERT(validate(test));}
+
+    void test_keep_topological_order_4 () {
+        graph_type test;
+        vertex_descriptor a = add_vertex(test);
+        vertex_descriptor b = add_vertex(test);
+        add_edge(a, b, test);
+        add_edge(b, a, test);
+        try {
+            keep_topological_order(test);
+            CPPUNIT_ASSERT(false);}
+        catch(boost::not_a_dag e) {
+            CPPUNIT_ASSERT(true);}}
+
+    void test_keep_topological_order_5 () {
+        // an edge is rejected exactly when it would close a cycle
+        graph_type test;
+        graph_type plain;
+        for(int i = 0; i < 300; ++i) {
+            add_vertex(test);
+            add_vertex(plain);}
+        keep_topological_order(test);
+        int rejected = 0;
+        for(int i = 0; i < 1500; ++i) {
+            vertex_descriptor u = (i * 7919) % 300;
+            vertex_descriptor v = (i * 104729 + 13) % 300;
+            graph_type closed(plain);
+            add_edge(u, v, closed);
+            try {
+                add_edge(u, v, test);
+                CPPUNIT_ASSERT(!has_cycle(closed));
+                plain = closed;}
+            catch(boost::not_a_dag e) {
+                CPPUNIT_ASSERT(has_cycle(closed));
+                ++rejected;}}
+        CPPUNIT_ASSERT(rejected > 0);
+        CPPUNIT_ASSERT(num_edges(test) == num_edges(plain));
+        CPPUNIT_ASSERT(validate(test));}
+
+    // ----------------
+    // test_remove_edge
+    // ----------------
+
+    void test_remove_edge_1 () {
+        graph_type test;
+        for(int i = 0; i < 3; ++i)
+            add_vertex(test);
+        add_edge(0, 1, test);
+        add_edge(0, 2, test);
+        add_edge(1, 2, test);
+        remove_edge(0, 1, test);
+        remove_edge(0, 1, test);
+        CPPUNIT_ASSERT(num_edges(test) == 2);
+        CPPUNIT_ASSERT(!edge(0, 1, test).second);
+        CPPUNIT_ASSERT(edge(0, 2, test).first == 1);
+        CPPUNIT_ASSERT(edge(1, 2, test).first == 2);
+        CPPUNIT_ASSERT(std::distance(adjacent_vertices(0, test).first, adjacent_vertices(0, test).second) == 1);
+        CPPUNIT_ASSERT(*adjacent_vertices(0, test).first == 2);
+        CPPUNIT_ASSERT(validate(test));}
+
+    void test_remove_edge_2 () {
+        graph_type test;
+        for(int i = 0; i < 3; ++i)
+            add_vertex(test);
+        add_edge(0, 1, test);
+        add_edge(1, 2, test);
+        add_edge(2, 0, test);
+        remove_edge(1, test);
+        std::pair<Graph::edge_iterator, Graph::edge_iterator> p = edges(test);
+        CPPUNIT_ASSERT(std::distance(p.first, p.second) == 2);
+        CPPUNIT_ASSERT(*p.first == 0);
+        CPPUNIT_ASSERT(*++p.first == 2);
+        CPPUNIT_ASSERT(!has_cycle(test));
+        // a re-added edge gets a new descriptor
+        CPPUNIT_ASSERT(add_edge(1, 2, test).first == 3);
+        CPPUNIT_ASSERT(has_cycle(test));
+        CPPUNIT_ASSERT(validate(test));}
+
+    void test_remove_edge_3 () {
+        // removed slots stay in the probe sequences of the edges after them
+        graph_type test;
+        for(int i = 0; i < 20; ++i)
+            add_vertex(test);
+        for(int i = 0; i < 20; ++i)
+            for(int j = 0; j < 20; ++j)
+                add_edge(i, j, test);
+        for(int i = 0; i < 20; ++i)
+            for(int j = 0; j < 20; ++j)
+                if((i + j) % 3 == 0)
+                    remove_edge(i, j, test);
+        for(int i = 0; i < 20; ++i)
+            for(int j = 0; j < 20; ++j)
+                CPPUNIT_ASSERT(edge(i, j, test).second == ((i + j) % 3 != 0));
+        for(int i = 0; i < 20; ++i)
+            add_edge(i, (20 - i) % 20, test);
+        CPPUNIT_ASSERT(validate(test));}
+
+    // -----------------
+    // test_clear_vertex
+    // -----------------
+
+    void test_clear_vertex_1 () {
+        graph_type test;
+        for(int i = 0; i < 4; ++i)
+            add_vertex(test);
+        add_edge(0, 1, test);
+        add_edge(1, 2, test);
+        add_edge(1, 1, test);
+        add_edge(3, 1, test);
+        add_edge(2, 3, test);
+        clear_vertex(1, test);
+        CPPUNIT_ASSERT(num_vertices(test) == 4);
+        CPPUNIT_ASSERT(num_edges(test) == 1);
+        CPPUNIT_ASSERT(edge(2, 3, test).first == 4);
+        CPPUNIT_ASSERT(adjacent_vertices(1, test).first == adjacent_vertices(1, test).second);
+        CPPUNIT_ASSERT(validate(test));}
+
+    void test_clear_vertex_2 () {
+        // a hub with out and in edges, a self loop, and in edges kept
+        graph_type test;
+        keep_in_edges(test);
+        for(int i = 0; i < 300; ++i)
+            add_vertex(test);
+        for(int i = 0; i < 300; ++i) {
+            add_edge(0, i, test);
+            add_edge(i, 0, test);
+            add_edge(i, (i + 1) % 300, test);}
+        const std::size_t before = num_edges(test);
+        clear_vertex(0, test);
+        CPPUNIT_ASSERT(num_edges(test) == before - 599);
+        CPPUNIT_ASSERT(out_degree(0, test) == 0);
+        CPPUNIT_ASSERT(in_degree(0, test) == 0);
+        CPPUNIT_ASSERT(in_degree(2, test) == 1);
+        CPPUNIT_ASSERT(edge(1, 2, test).second);
+        CPPUNIT_ASSERT(!edge(299, 0, test).second);
+        CPPUNIT_ASSERT(validate(test));
+        compact(test);
+        CPPUNIT_ASSERT(validate(test));}
+
+    // ------------------
+    // test_remove_vertex
+    // ------------------
+
+    void test_remove_vertex_1 () {
+        graph_type test;
+        for(int i = 0; i < 4; ++i)
+            add_vertex(test);
+        add_edge(0, 1, test);
+        add_edge(1, 2, test);
+        add_edge(2, 3, test);
+        remove_vertex(1, test);
+        CPPUNIT_ASSERT(num_vertices(test) == 3);
+        CPPUNIT_ASSERT(num_edges(test) == 1);
+        CPPUNIT_ASSERT(add_vertex(test) == 4);
+        std::pair<Graph::vertex_iterator, Graph::vertex_iterator> p = vertices(test);
+        std::ostringstream out;
+        std::copy(p.first, p.second, std::ostream_iterator<vertex_descriptor>(out, " "));
+        CPPUNIT_ASSERT(out.str() == "0 2 3 4 ");
+        std::vector<vertex_descriptor> order;
+        topological_sort(test, std::back_inserter(order));
+        CPPUNIT_ASSERT(order.size() == 4);
+        CPPUNIT_ASSERT(std::find(order.begin(), order.end(), 1) == order.end());
+        CPPUNIT_ASSERT(validate(test));}
+
+    void test_remove_vertex_2 () {
+        graph_type test;
+        for(int i = 0; i < 4; ++i)
+            add_vertex(test);
+        add_edge(0, 2, test);
+        add_edge(2, 1, test);
+        add_edge(1, 3, test);
+        keep_topological_order(test);
+        remove_vertex(2, test);
+        add_edge(3, 0, test);
+        std::vector<vertex_descriptor> order;
+        topological_sort(test, std::back_inserter(order));
+        std::ostringstream out;
+        std::copy(order.begin(), order.end(), std::ostream_iterator<vertex_descriptor>(out, " "));
+        CPPUNIT_ASSERT(out.str() == "0 3 1 ");
+        CPPUNIT_ASSERT(validate(test));}
+
+    // ------------
+    // test_compact
+    // ------------
+
+    void test_compact_1 () {
+        graph_type test;
+        for(int i = 0; i < 5; ++i)
+            add_vertex(test);
+        add_edge(0, 1, test);
+        add_edge(1, 2, test);
+        add_edge(2, 3, test);
+        add_edge(3, 4, test);
+        add_edge(4, 0, test);
+        add_edge(0, 3, test);
+        remove_vertex(2, test);
+        remove_edge(4, 0, test);
+        graph_type::remapping r = compact(test);
+        CPPUNIT_ASSERT(r.vertices.size() == 5);
+        CPPUNIT_ASSERT(r.vertices[1] == 1);
+        CPPUNIT_ASSERT(r.vertices[2] == -1);
+        CPPUNIT_ASSERT(r.vertices[4] == 3);
+        CPPUNIT_ASSERT(r.edges.size() == 6);
+        CPPUNIT_ASSERT(r.edges[1] == -1);
+        CPPUNIT_ASSERT(r.edges[3] == 1);
+        CPPUNIT_ASSERT(r.edges[5] == 2);
+        CPPUNIT_ASSERT(num_vertices(test) == 4);
+        CPPUNIT_ASSERT(vertex_bound(test) == 4);
+        CPPUNIT_ASSERT(num_edges(test) == 3);
+        CPPUNIT_ASSERT(edge(2, 3, test).first == 1);
+        CPPUNIT_ASSERT(edge(0, 2, test).first == 2);
+        CPPUNIT_ASSERT(source(2, test) == 0);
+        CPPUNIT_ASSERT(target(2, test) == 2);
+        CPPUNIT_ASSERT(validate(test));}
+
+    void test_compact_2 () {
+        graph_type test;
+        keep_topological_order(test);
+        for(int i = 0; i < 6; ++i)
+            add_vertex(test);
+        for(int i = 5; i > 0; --i)
+            add_edge(i, i - 1, test);
+        remove_vertex(0, test);
+        remove_vertex(3, test);
+        compact(test);
+        CPPUNIT_ASSERT(num_vertices(test) == 4);
+        CPPUNIT_ASSERT(num_edges(test) == 2);
+        add_edge(1, 0, test);
+        std::vector<vertex_descriptor> order;
+        topological_sort(test, std::back_inserter(order));
+        std::ostringstream out;
+        std::copy(order.begin(), order.end(), std::ostream_iterator<vertex_descriptor>(out, " "));
+        CPPUNIT_ASSERT(out.str() == "0 1 2 3 ");
+        CPPUNIT_ASSERT(validate(test));}
+
+    // -------------
+    // test_in_edges
+    // -------------
+
+    void test_in_edges_1 () {
+        graph_type test;
+        for(int i = 0; i < 4; ++i)
+            add_vertex(test);
+        add_edge(0, 3, test);
+        add_edge(1, 3, test);
+        keep_in_edges(test);
+        add_edge(2, 3, test);
+        add_edge(3, 0, test);
+        CPPUNIT_ASSERT(in_degree(3, test) == 3);
+        CPPUNIT_ASSERT(in_degree(1, test) == 0);
+        std::pair<Graph::in_edge_iterator, Graph::in_edge_iterator> p = in_edges(3, test);
+        CPPUNIT_ASSERT(std::distance(p.first, p.second) == 3);
+        for(int i = 0; p.first != p.second; ++p.first, ++i) {
+            CPPUNIT_ASSERT(source(*p.first, test) == i);
+            CPPUNIT_ASSERT(target(*p.first, test) == 3);}
+        CPPUNIT_ASSERT(validate(test));}
+
+    void test_in_edges_2 () {
+        graph_type test;
+        keep_in_edges(test);
+        for(int i = 0; i < 5; ++i)
+            add_vertex(test);
+        add_edge(0, 4, test);
+        add_edge(2, 4, test);
+        add_edge(3, 4, test);
+        add_edge(4, 1, test);
+        remove_edge(2, 4, test);
+        std::pair<Graph::inv_adjacency_iterator, Graph::inv_adjacency_iterator> p = inv_adjacent_vertices(4, test);
+        std::ostringstream out;
+        std::copy(p.first, p.second, std::ostream_iterator<vertex_descriptor>(out, " "));
+        CPPUNIT_ASSERT(out.str() == "0 3 ");
+        remove_vertex(4, test);
+        CPPUNIT_ASSERT(num_edges(test) == 0);
+        CPPUNIT_ASSERT(in_degree(1, test) == 0);
+        CPPUNIT_ASSERT(validate(test));}
+
+    void test_in_edges_3 () {
+        graph_type test;
+        keep_in_edges(test);
+        for(int i = 0; i < 4; ++i)
+            add_vertex(test);
+        add_edge(0, 3, test);
+        add_edge(1, 3, test);
+        add_edge(2, 3, test);
+        remove_vertex(1, test);
+        compact(test);
+        CPPUNIT_ASSERT(in_degree(2, test) == 2);
+        CPPUNIT_ASSERT(*in_edges(2, test).first == 0);
+        CPPUNIT_ASSERT(*inv_adjacent_vertices(2, test).first == 0);
+        CPPUNIT_ASSERT(*++inv_adjacent_vertices(2, test).first == 1);
+        CPPUNIT_ASSERT(validate(test));}
+
+    // ---------------
+    // test_out_degree
+    // ---------------
+
+    void test_out_degree_1 () {
+        graph_type test;
+        for(int i = 0; i < 3; ++i)
+            add_vertex(test);
+        add_edge(0, 1, test);
+        add_edge(0, 2, test);
+        add_edge(0, 2, test);
+        CPPUNIT_ASSERT(out_degree(0, test) == 2);
+        CPPUNIT_ASSERT(out_degree(2, test) == 0);}
+
+    // ------------------
+    // test_edge_property
+    // ------------------
+
+    void test_edge_property_1 () {
+        basic_graph<int, double> test;
+        for(int i = 0; i < 3; ++i)
+            add_vertex(test);
+        add_edge(0, 1, 2.5, test);
+        add_edge(1, 2, test);
+        CPPUNIT_ASSERT(!add_edge(0, 1, 7.0, test).second);
+        CPPUNIT_ASSERT(test[0] == 2.5);
+        CPPUNIT_ASSERT(test[1] == 0.0);
+        test[edge(1, 2, test).first] = 4.0;
+        double total = 0;
+        std::pair<basic_graph<int, double>::edge_iterator, basic_graph<int, double>::edge_iterator> p = edges(test);
+        for(; p.first != p.second; ++p.first)
+            total += test[*p.first];
+        CPPUNIT_ASSERT(total == 6.5);
+        CPPUNIT_ASSERT(validate(test));}
+
+    void test_edge_property_2 () {
+        // properties follow their edges through removal and compact
+        basic_graph<int, std::string> test;
+        for(int i = 0; i < 4; ++i)
+            add_vertex(test);
+        add_edge(0, 1, "a", test);
+        add_edge(1, 2, "b", test);
+        add_edge(2, 3, "c", test);
+        remove_vertex(1, test);
+        compact(test);
+        CPPUNIT_ASSERT(num_edges(test) == 1);
+        CPPUNIT_ASSERT(test[edge(1, 2, test).first] == "c");
+        CPPUNIT_ASSERT(validate(test));}
+
+    // ---------------
+    // test_index_type
+    // ---------------
+
+    void test_index_type_1 () {
+        CPPUNIT_ASSERT(sizeof(stored_edge<uint32_t, no_edge_property>) == 8);
+        CPPUNIT_ASSERT(sizeof(stored_edge<uint64_t, no_edge_property>) == 16);
+        CPPUNIT_ASSERT(basic_graph<uint32_t>::null_vertex() == 0xFFFFFFFFu);}
+
+    void test_index_type_2 () {
+        typedef basic_graph<uint64_t, float> wide;
+        wide test;
+        keep_in_edges(test);
+        for(int i = 0; i < 5; ++i)
+            add_vertex(test);
+        for(uint64_t i = 0; i < 4; ++i)
+            add_edge(i, i + 1, i + 0.5f, test);
+        keep_topological_order(test);
+        remove_vertex(2, test);
+        wide::remapping r = compact(test);
+        CPPUNIT_ASSERT(r.vertices[2] == wide::null_vertex());
+        CPPUNIT_ASSERT(r.vertices[4] == 3);
+        CPPUNIT_ASSERT(r.edges[1] == wide::null_edge());
+        CPPUNIT_ASSERT(num_edges(test) == 2);
+        CPPUNIT_ASSERT(test[edge(2, 3, test).first] == 3.5f);
+        CPPUNIT_ASSERT(in_degree(3, test) == 1);
+        try {
+            add_edge(3, 2, test);
+            CPPUNIT_ASSERT(false);}
+        catch(boost::not_a_dag e) {
+            CPPUNIT_ASSERT(true);}
+        CPPUNIT_ASSERT(validate(test));}
+
+    void test_index_type_3 () {
+        // the 65535th vertex would be null_vertex()
+        basic_graph<uint16_t> test;
+        for(int i = 0; i < 65535; ++i)
+            add_vertex(test);
+        try {
+            add_vertex(test);
+            CPPUNIT_ASSERT(false);}
+        catch(std::length_error& e) {
+            CPPUNIT_ASSERT(num_vertices(test) == 65535);}}
+
+    void test_index_type_4 () {
+        // the 65535th edge would be the removed slot of the edge table
+        basic_graph<uint16_t> test;
+        for(int i = 0; i < 300; ++i)
+            add_vertex(test);
+        int added = 0;
+        try {
+            for(uint16_t u = 0; u < 300; ++u)
+                for(uint16_t v = 0; v < 300; ++v)
+                    if(u != v) {
+                        add_edge(u, v, test);
+                        ++added;}
+            CPPUNIT_ASSERT(false);}
+        catch(std::length_error& e) {
+            CPPUNIT_ASSERT(added == 65534);}
+        CPPUNIT_ASSERT(num_edges(test) == 65534);
+        CPPUNIT_ASSERT(edge(219, 52, test).second);
+        CPPUNIT_ASSERT(!edge(219, 53, test).second);
+        CPPUNIT_ASSERT(validate(test));}
+
+    // ----------------
+    // test_graph_stats
+    // ----------------
+
+    void test_graph_stats_1 () {
+        graph_type test;
+        for(int i = 0; i < 3; ++i)
+            add_vertex(test);
+        add_edge(0, 1, test);
+        add_edge(0, 2, test);
+        add_edge(0, 1, test);
+        edge(1, 0, test);
+        graph_statistics s = graph_stats(test);
+#if GRAPH_STATS
+        // the first lookup finds etable empty and probes nothing
+        CPPUNIT_ASSERT(s.edge_lookups == 4);
+        CPPUNIT_ASSERT(s.edge_probes >= 3);
+        CPPUNIT_ASSERT(s.max_probe >= 1);
+        CPPUNIT_ASSERT(s.row_reallocations == 2);
+#else
+        CPPUNIT_ASSERT(s.edge_lookups == 0);
+        CPPUNIT_ASSERT(s.row_reallocations == 0);
+#endif
+        reset_graph_stats(test);
+        CPPUNIT_ASSERT(graph_stats(test).edge_lookups == 0);}
+
+    void test_graph_stats_2 () {
+        graph_type test;
+        for(int i = 0; i < 4; ++i)
+            add_vertex(test);
+        add_edge(0, 1, test);
+        add_edge(1, 2, test);
+        add_edge(0, 3, test);
+        CPPUNIT_ASSERT(!has_cycle(test));
+        graph_statistics s = graph_stats(test);
+#if GRAPH_STATS
+        CPPUNIT_ASSERT(s.algorithm_calls == 1);
+        CPPUNIT_ASSERT(std::string(s.last.algorithm) == "has_cycle");
+        CPPUNIT_ASSERT(s.last.vertices == 4);
+        CPPUNIT_ASSERT(s.last.edges == 3);
+        CPPUNIT_ASSERT(s.last.max_depth == 3);
+#else
+        CPPUNIT_ASSERT(s.algorithm_calls == 0);
+#endif
+        std::vector<vertex_descriptor> order;
+        topological_sort(test, std::back_inserter(order));
+        s = graph_stats(test);
+#if GRAPH_STATS
+        // the cycle check and the sort
+        CPPUNIT_ASSERT(s.algorithm_calls == 3);
+        CPPUNIT_ASSERT(std::string(s.last.algorithm) == "topological_sort");
+        CPPUNIT_ASSERT(s.last.vertices == 4);
+        CPPUNIT_ASSERT(s.last.edges == 6);
+        CPPUNIT_ASSERT(s.vertices_visited == 12);
+        CPPUNIT_ASSERT(s.max_depth == 3);
+#else
+        CPPUNIT_ASSERT(s.algorithm_calls == 0);
+#endif
+        }
+
+    void test_graph_stats_4 () {
+        // readers on several threads share one graph and its counters
+        graph_type test;
+        for(int i = 0; i < 10; ++i)
+            add_vertex(test);
+        for(int i = 0; i < 9; ++i)
+            add_edge(i, i + 1, test);
+        reset_graph_stats(test);
+        const graph_type& shared = test;
+        std::vector<std::thread> readers;
+        for(int t = 0; t < 4; ++t)
+            readers.push_back(std::thread([&shared] () {
+                for(int i = 0; i < 1000; ++i)
+                    edge(i % 10, (i + 1) % 10, shared);}));
+        for(int t = 0; t < 4; ++t)
+            readers[t].join();
+#if GRAPH_STATS
+        CPPUNIT_ASSERT(graph_stats(test).edge_lookups == 4000);
+#else
+        CPPUNIT_ASSERT(graph_stats(test).edge_lookups == 0);
+#endif
+        }
+
+    void test_graph_stats_5 () {
+        // rows sized once by add_edges against rows doubled by add_edge
+        std::vector< std::pair<vertex_descriptor, vertex_descriptor> > input;
+        for(int u = 0; u < 100; ++u)
+            for(int k = 0; k < 50; ++k)
+                input.push_back(std::make_pair(u, (u + 1 + k) % 100));
+        graph_type bulk(100, input.begin(), input.end());
+        graph_type single;
+        for(int i = 0; i < 100; ++i)
+            add_vertex(single);
+        for(unsigned int i = 0; i < input.size(); ++i)
+            add_edge(input[i].first, input[i].second, single);
+        CPPUNIT_ASSERT(num_edges(bulk) == 5000);
+#if GRAPH_STATS
+        CPPUNIT_ASSERT(graph_stats(bulk).row_reallocations == 100);
+        CPPUNIT_ASSERT(graph_stats(single).row_reallocations == 700);
+#else
+        CPPUNIT_ASSERT(graph_stats(bulk).row_reallocations == 0);
+#endif
+        }
+
+    void test_graph_stats_3 () {
+        graph_type test;
+        std::ostringstream out;
+        write_json(out, graph_stats(test));
+        CPPUNIT_ASSERT(out.str() ==
+            "{\"edge_lookups\":0,\"edge_probes\":0,\"max_probe\":0,\"row_reallocations\":0,"
+            "\"algorithm_calls\":0,\"vertices_visited\":0,\"edges_visited\":0,\"max_depth\":0,"
+            "\"last\":{\"algorithm\":\"\",\"vertices\":0,\"edges\":0,\"max_depth\":0}}");}
+
+    // -----
+    // suite
+    // -----
+
+    CPPUNIT_TEST_SUITE(TestGraphExtensions);
+    CPPUNIT_TEST(test_validate_1);
+    CPPUNIT_TEST(test_validate_2);
+    CPPUNIT_TEST(test_add_edges_1);
+    CPPUNIT_TEST(test_add_edges_2);
+    CPPUNIT_TEST(test_add_edges_3);
+    CPPUNIT_TEST(test_add_edges_4);
+    CPPUNIT_TEST(test_reserve_1);
+    CPPUNIT_TEST(test_keep_topological_order_1);
+    CPPUNIT_TEST(test_keep_topological_order_2);
+    CPPUNIT_TEST(test_keep_topological_order_3);
+    CPPUNIT_TEST(test_keep_topological_order_4);
+    CPPUNIT_TEST(test_keep_topological_order_5);
+    CPPUNIT_TEST(test_remove_edge_1);
+    CPPUNIT_TEST(test_remove_edge_2);
+    CPPUNIT_TEST(test_remove_edge_3);
+    CPPUNIT_TEST(test_clear_vertex_1);
+    CPPUNIT_TEST(test_clear_vertex_2);
+    CPPUNIT_TEST(test_remove_vertex_1);
+    CPPUNIT_TEST(test_remove_vertex_2);
+    CPPUNIT_TEST(test_compact_1);
+    CPPUNIT_TEST(test_compact_2);
+    CPPUNIT_TEST(test_in_edges_1);
+    CPPUNIT_TEST(test_in_edges_2);
+    CPPUNIT_TEST(test_in_edges_3);
+    CPPUNIT_TEST(test_out_degree_1);
+    CPPUNIT_TEST(test_edge_property_1);
+    CPPUNIT_TEST(test_edge_property_2);
+    CPPUNIT_TEST(test_index_type_1);
+    CPPUNIT_TEST(test_index_type_2);
+    CPPUNIT_TEST(test_index_type_3);
+    CPPUNIT_TEST(test_index_type_4);
+    CPPUNIT_TEST(test_graph_stats_1);
+    CPPUNIT_TEST(test_graph_stats_2);
+    CPPUNIT_TEST(test_graph_stats_3);
+    CPPUNIT_TEST(test_graph_stats_4);
+    CPPUNIT_TEST(test_graph_stats_5);
+    CPPUNIT_TEST_SUITE_END();};
+
+
+// ------------
+// TestCsrGraph
+// ------------
+
+struct TestCsrGraph : CppUnit::TestFixture {
+    // --------
+    // typedefs
+    // --------
+
+    typedef CsrGraph                                graph_type;
+
+    typedef graph_type::vertex_descriptor           vertex_descriptor;
+    typedef graph_type::edge_descriptor             edge_descriptor;
+
+    typedef graph_type::vertex_iterator             vertex_iterator;
+    typedef graph_type::edge_iterator               edge_iterator;
+    typedef graph_type::adjacency_iterator          adjacency_iterator;
+
+    // -----
+    // tests
+    // -----
+
+    // the TestGraph fixture, built as a Graph and then frozen
+    Graph      builder;
+    graph_type g;
+
+    // -----
+    // setUp
+    // -----
+
+    static Graph build () {
+        Graph b;
+        for(int i = 0; i < 8; ++i)
+            add_vertex(b);
+        add_edge(0, 1, b);
+        add_edge(0, 2, b);
+        add_edge(0, 4, b);
+        add_edge(1, 3, b);
+        add_edge(1, 4, b);
+        add_edge(2, 3, b);
+        add_edge(3, 4, b);
+        add_edge(3, 5, b);
+        add_edge(5, 3, b);
+        add_edge(5, 7, b);
+        add_edge(6, 7, b);
+        return b;}
+
+    TestCsrGraph () :
+            builder(build()),
+            g(builder)
+        {}
+
+    // ----------------------
+    // test_adjacent_vertices
+    // ----------------------
+
+    void test_adjacent_vertices_1 () {
+        std::pair<adjacency_iterator, adjacency_iterator> p = adjacent_vertices(0, g);
+        CPPUNIT_ASSERT(std::distance(p.first, p.second) == 3);
+        CPPUNIT_ASSERT(p.first[0] == 1);
+        CPPUNIT_ASSERT(p.first[1] == 2);
+        CPPUNIT_ASSERT(p.first[2] == 4);}
+
+    void test_adjacent_vertices_2 () {
+        std::pair<adjacency_iterator, adjacency_iterator> p = adjacent_vertices(7, g);
+        CPPUNIT_ASSERT(p.first == p.second);}
+
+    // ---------
+    // test_edge
+    // ---------
+
+    void test_edge_1 () {
+        for(int v = 0; v < 8; ++v)
+            for(int w = 0; w < 8; ++w) {
+                std::pair<edge_descriptor, bool> p = edge(v, w, g);
+                CPPUNIT_ASSERT(p.second == edge(v, w, builder).second);
+                if(p.second) {
+                    CPPUNIT_ASSERT(source(p.first, g) == v);
+                    CPPUNIT_ASSERT(target(p.first, g) == w);}}}
+
+    void test_edge_2 () {
+        std::pair<edge_descriptor, bool> p = edge(1, 0, g);
+        CPPUNIT_ASSERT(p.second == false);}
+
+    // ----------
+    // test_edges
+    // ----------
+
+    void test_edges_1 () {
+        std::pair<edge_iterator, edge_iterator> p = edges(g);
+        CPPUNIT_ASSERT(std::distance(p.first, p.second) == 11);
+        CPPUNIT_ASSERT(num_edges(g) == 11);
+        CPPUNIT_ASSERT(source(*p.first, g) == 0);
+        CPPUNIT_ASSERT(target(*p.first, g) == 1);}
+
+    void test_edges_2 () {
+        std::vector< std::pair<vertex_descriptor, vertex_descriptor> > none;
+        graph_type empty(0, none.begin(), none.end());
+        std::pair<edge_iterator, edge_iterator> p = edges(empty);
+        CPPUNIT_ASSERT(p.first == p.second);
+        CPPUNIT_ASSERT(num_vertices(empty) == 0);}
+
+    // -----------
+    // test_source
+    // -----------
+
+    void test_source_1 () {
+        std::pair<edge_iterator, edge_iterator> p = edges(g);
+        for(edge_iterator b = p.first; b != p.second; ++b)
+            CPPUNIT_ASSERT(edge(source(*b, g), target(*b, g), g).first == *b);}
+
+    // -------------
+    // test_vertices
+    // -------------
+
+    void test_vertices_1 () {
+        std::pair<vertex_iterator, vertex_iterator> p = vertices(g);
+        CPPUNIT_ASSERT(std::distance(p.first, p.second) == 8);
+        CPPUNIT_ASSERT(num_vertices(g) == 8);
+        CPPUNIT_ASSERT(*p.first == vertex(0, g));}
+
+    // ------------------
+    // test_edge_list_ctor
+    // ------------------
+
+    void test_edge_list_ctor_1 () {
+        std::vector< std::pair<vertex_descriptor, vertex_descriptor> > input;
+        input.push_back(std::make_pair(2, 0));
+        input.push_back(std::make_pair(0, 2));
+        input.push_back(std::make_pair(0, 1));
+        input.push_back(std::make_pair(2, 0));
+        graph_type test(3, input.begin(), input.end());
+        CPPUNIT_ASSERT(num_vertices(test) == 3);
+        CPPUNIT_ASSERT(num_edges(test) == 3);
+        CPPUNIT_ASSERT(edge(0, 1, test).first == 0);
+        CPPUNIT_ASSERT(edge(0, 2, test).first == 1);
+        CPPUNIT_ASSERT(edge(2, 0, test).first == 2);
+        CPPUNIT_ASSERT(adjacent_vertices(1, test).first == adjacent_vertices(1, test).second);}
+
+    // --------------
+    // test_has_cycle
+    // --------------
+
+    void test_has_cycle_1 () {
+        std::ostringstream out;
+        CPPUNIT_ASSERT(has_cycle(g, std::ostream_iterator<vertex_descriptor>(out, " ")));
+        CPPUNIT_ASSERT(out.str() == "3 5 ");}
+
+    // ---------------------
+    // test_topological_sort
+    // ---------------------
+
+    void test_topological_sort_1 () {
+        std::vector< std::pair<vertex_descriptor, vertex_descriptor> > input;
+        input.push_back(std::make_pair(1, 8));
+        input.push_back(std::make_pair(1, 6));
+        input.push_back(std::make_pair(2, 9));
+        input.push_back(std::make_pair(3, 2));
+        input.push_back(std::make_pair(3, 0));
+        input.push_back(std::make_pair(3, 7));
+        input.push_back(std::make_pair(4, 2));
+        input.push_back(std::make_pair(4, 5));
+        input.push_back(std::make_pair(5, 0));
+        input.push_back(std::make_pair(6, 5));
+        input.push_back(std::make_pair(7, 4));
+        input.push_back(std::make_pair(7, 0));
+        input.push_back(std::make_pair(8, 0));
+        input.push_back(std::make_pair(8, 3));
+        input.push_back(std::make_pair(8, 6));
+        input.push_back(std::make_pair(8, 2));
+        input.push_back(std::make_pair(8, 5));
+        input.push_back(std::make_pair(9, 6));
+        graph_type test(10, input.begin(), input.end());
+        std::ostringstream out;
+        topological_sort(test, std::ostream_iterator<vertex_descriptor>(out, " "));
+        CPPUNIT_ASSERT(out.str() == "0 5 6 9 2 4 7 3 8 1 ");}
+
+    void test_topological_sort_2 () {
+        try {
+            std::ostringstream out;
+            topological_sort(g, std::ostream_iterator<vertex_descriptor>(out, " "));
+            CPPUNIT_ASSERT(false);}
+        catch(boost::not_a_dag e) {
+            CPPUNIT_ASSERT(true);}}
+
+    // -----
+    // suite
+    // -----
+
+    CPPUNIT_TEST_SUITE(TestCsrGraph);
+    CPPUNIT_TEST(test_adjacent_vertices_1);
+    CPPUNIT_TEST(test_adjacent_vertices_2);
+    CPPUNIT_TEST(test_edge_1);
+    CPPUNIT_TEST(test_edge_2);
+    CPPUNIT_TEST(test_edges_1);
+    CPPUNIT_TEST(test_edges_2);
+    CPPUNIT_TEST(test_source_1);
+    CPPUNIT_TEST(test_vertices_1);
+    CPPUNIT_TEST(test_edge_list_ctor_1);
+    CPPUNIT_TEST(test_has_cycle_1);
+    CPPUNIT_TEST(test_topological_sort_1);
+    CPPUNIT_TEST(test_topological_sort_2);
+    CPPUNIT_TEST_SUITE_END();};
+
+
+// ---------------
+// TestMappedGraph
+// ---------------
+
+struct TestMappedGraph : CppUnit::TestFixture {
+    // --------
+    // typedefs
+    // --------
+
+    typedef MappedGraph                             graph_type;
+
+    typedef graph_type::vertex_descriptor           vertex_descriptor;
+    typedef graph_type::edge_descriptor             edge_descriptor;
+
+    typedef graph_type::edge_iterator               edge_iterator;
+    typedef graph_type::adjacency_iterator          adjacency_iterator;
+
+    // -----
+    // tests
+    // -----
+
+    static const char* path () {
+        return "TestMappedGraph.tmp";}
+
+    // the TestGraph fixture, saved from a Graph
+    Graph builder;
+
+    // --------------
+    // setUp/tearDown
+    // --------------
+
+    void setUp () {
+        builder = TestCsrGraph::build();
+        save(builder, path());}
+
+    void tearDown () {
+        std::remove(path());}
+
+    // ---------------
+    // test_round_trip
+    // ---------------
+
+    void test_round_trip_1 () {
+        graph_type g(path());
+        CPPUNIT_ASSERT(num_vertices(g) == 8);
+        CPPUNIT_ASSERT(num_edges(g) == 11);
+        for(int v = 0; v < 8; ++v) {
+            std::pair<adjacency_iterator, adjacency_iterator> p = adjacent_vertices(v, g);
+            std::pair<Graph::adjacency_iterator, Graph::adjacency_iterator> q = adjacent_vertices(v, builder);
+            CPPUNIT_ASSERT(std::distance(p.first, p.second) == std::distance(q.first, q.second));
+            CPPUNIT_ASSERT(std::equal(q.first, q.second, p.first));}}
+
+    void test_round_trip_2 () {
+        graph_type g(path(), false);
+        CsrGraph   c(builder);
+        std::pair<edge_iterator, edge_iterator> p = edges(g);
+        CPPUNIT_ASSERT(std::distance(p.first, p.second) == 11);
+        for(; p.first != p.second; ++p.first) {
+            CPPUNIT_ASSERT(source(*p.first, g) == source(*p.first, c));
+            CPPUNIT_ASSERT(target(*p.first, g) == target(*p.first, c));
+            CPPUNIT_ASSERT(edge(source(*p.first, g), target(*p.first, g), g).first == *p.first);}
+        CPPUNIT_ASSERT(!edge(1, 0, g).second);}
+
+    void test_round_trip_3 () {
+        std::vector< std::pair<vertex_descriptor, vertex_descriptor> > none;
+        save(CsrGraph(4, none.begin(), none.end()), path());
+        graph_type g(path());
+        CPPUNIT_ASSERT(num_vertices(g) == 4);
+        CPPUNIT_ASSERT(num_edges(g) == 0);
+        CPPUNIT_ASSERT(!has_cycle(g));}
+
+    void test_round_trip_4 () {
+        // saving over a mapped file leaves the mapping on the old contents
+        graph_type g(path());
+        std::vector< std::pair<vertex_descriptor, vertex_descriptor> > none;
+        save(CsrGraph(5000, none.begin(), none.end()), path());
+        CPPUNIT_ASSERT(num_edges(g) == 11);
+        for(int v = 0; v < 8; ++v) {
+            std::pair<adjacency_iterator, adjacency_iterator> p = adjacent_vertices(v, g);
+            std::pair<Graph::adjacency_iterator, Graph::adjacency_iterator> q = adjacent_vertices(v, builder);
+            CPPUNIT_ASSERT(std::equal(q.first, q.second, p.first));}
+        graph_type reloaded(path());
+        CPPUNIT_ASSERT(num_vertices(reloaded) == 5000);
+        CPPUNIT_ASSERT(num_edges(reloaded) == 0);}
+
+    static void save_builder (const Graph* g) {
+        for(int i = 0; i != 50; ++i)
+            save(*g, path());}
+
+    void test_round_trip_5 () {
+        // concurrent saves to one path each write their own temporary file
+        std::thread a(save_builder, &builder);
+        std::thread b(save_builder, &builder);
+        a.join();
+        b.join();
+        graph_type g(path());
+        CPPUNIT_ASSERT(num_edges(g) == 11);}
+
+    // ----------------
+    // test_algorithms
+    // ----------------
+
+    void test_algorithms_1 () {
+        graph_type g(path());
+        std::ostringstream out;
+        CPPUNIT_ASSERT(has_cycle(g, std::ostream_iterator<vertex_descriptor>(out, " ")));
+        CPPUNIT_ASSERT(out.str() == "3 5 ");}
+
+    // ----------
+    // test_check
+    // ----------
+
+    // overwrite one byte of the saved file
+    static void corrupt (long offset, char c) {
+        std::fstream f(path(), std::ios::in | std::ios::out | std::ios::binary);
+        f.seekp(offset);
+        f.put(c);}
+
+    void test_check_1 () {
+        corrupt(sizeof(graph_header) + 9 * sizeof(uint64_t) + 1, 7);
+        try {
+            graph_type g(path());
+            CPPUNIT_ASSERT(false);}
+        catch(std::runtime_error& e) {
+            CPPUNIT_ASSERT(std::string(e.what()).find("checksum") != std::string::npos);}}
+
+    void test_check_2 () {
+        corrupt(4, 9);
+        try {
+            graph_type g(path(), false);
+            CPPUNIT_ASSERT(false);}
+        catch(std::runtime_error& e) {
+            CPPUNIT_ASSERT(std::string(e.what()).find("version") != std::string::npos);}}
+
+    void test_check_4 () {
+        // counts whose sizes overflow when multiplied are rejected
+        graph_header h;
+        std::memcpy(h.magic, graph_magic, sizeof(h.magic));
+        h.version      = graph_version;
+        h.num_vertices = (uint64_t(1) << 61) - 1;
+        h.num_edges    = 0;
+        h.checksum     = 0;
+        std::ofstream out(path(), std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        out.close();
+        try {
+            graph_type g(path(), false);
+            CPPUNIT_ASSERT(false);}
+        catch(std::runtime_error& e) {
+            CPPUNIT_ASSERT(std::string(e.what()).find("size") != std::string::npos);}}
+
+    void test_check_3 () {
+        try {
+            graph_type g("TestMappedGraph.missing");
+            CPPUNIT_ASSERT(false);}
+        catch(std::runtime_error& e) {
+            CPPUNIT_ASSERT(true);}}
+
+    // -----
+    // suite
+    // -----
+
+    CPPUNIT_TEST_SUITE(TestMappedGraph);
+    CPPUNIT_TEST(test_round_trip_1);
+    CPPUNIT_TEST(test_round_trip_2);
+    CPPUNIT_TEST(test_round_trip_3);
+    CPPUNIT_TEST(test_round_trip_4);
+    CPPUNIT_TEST(test_round_trip_5);
+    CPPUNIT_TEST(test_algorithms_1);
+    CPPUNIT_TEST(test_check_1);
+    CPPUNIT_TEST(test_check_2);
+    CPPUNIT_TEST(test_check_3);
+    CPPUNIT_TEST(test_check_4);
+    CPPUNIT_TEST_SUITE_END();};
+
+// ---------
+// TestArena
+// ---------
+
+struct TestArena : CppUnit::TestFixture {
+    // --------
+    // typedefs
+    // --------
+
+    typedef basic_graph<int, no_edge_property, arena_allocator<int> > graph_type;
+
+    // -------------
+    // test_allocate
+    // -------------
+
+    void test_allocate_1 () {
+        arena a(1024);
+        void* p = a.allocate(12);
+        void* q = a.allocate(16);
+        CPPUNIT_ASSERT(p != q);
+        CPPUNIT_ASSERT(a.bytes_reserved() == 1024);
+        a.deallocate(p, 12);
+        CPPUNIT_ASSERT(a.allocate(9) == p);
+        CPPUNIT_ASSERT(a.allocate(16) != p);}
+
+    void test_allocate_2 () {
+        arena a(1024);
+        void* p = a.allocate(1000);
+        CPPUNIT_ASSERT(a.bytes_reserved() == 1024);
+        a.deallocate(p, 1000);
+        CPPUNIT_ASSERT(a.allocate(600) == p);
+        a.allocate(1);
+        CPPUNIT_ASSERT(a.bytes_reserved() == 2048);}
+
+    // ----------------
+    // test_arena_graph
+    // ----------------
+
+    void test_arena_graph_1 () {
+        arena_allocator<int> alloc;
+        graph_type test(alloc);
+        for(int i = 0; i < 100; ++i)
+            add_vertex(test);
+        for(int i = 0; i < 100; ++i)
+            for(int j = 0; j < 10; ++j)
+                add_edge(i, (i + j) % 100, test);
+        // the rows grow through 1, 2, 4, 8 and 16 ints, reusing freed buffers
+        CPPUNIT_ASSERT(alloc.get_arena().bytes_reserved() == 64 * 1024);
+        CPPUNIT_ASSERT(validate(test));}
+
+    void test_arena_graph_2 () {
+        // a copy gets its own arena and outlives the original
+        arena_allocator<int> alloc;
+        graph_type* original = new graph_type(alloc);
+        for(int i = 0; i < 3; ++i)
+            add_vertex(*original);
+        add_edge(0, 1, *original);
+        add_edge(1, 2, *original);
+        const std::size_t reserved = alloc.get_arena().bytes_reserved();
+        graph_type copy(*original);
+        delete original;
+        add_edge(2, 0, copy);
+        for(int i = 0; i < 1000; ++i)
+            add_vertex(copy);
+        for(int i = 0; i < 1000; ++i)
+            for(int j = 0; j < 20; ++j)
+                add_edge(i, (i * 7 + j) % 1003, copy);
+        CPPUNIT_ASSERT(alloc.get_arena().bytes_reserved() == reserved);
+        CPPUNIT_ASSERT(has_cycle(copy));
+        CPPUNIT_ASSERT(validate(copy));}
+
+    void test_arena_graph_3 () {
+        // an assigned graph takes a new arena too
+        arena_allocator<int> alloc;
+        graph_type original(alloc);
+        graph_type assigned;
+        for(int i = 0; i < 3; ++i)
+            add_vertex(original);
+        add_edge(0, 1, original);
+        assigned = original;
+        const std::size_t reserved = alloc.get_arena().bytes_reserved();
+        for(int i = 0; i < 2000; ++i)
+            add_vertex(assigned);
+        for(int i = 0; i < 2000; ++i)
+            add_edge(i, 3 + i, assigned);
+        CPPUNIT_ASSERT(alloc.get_arena().bytes_reserved() == reserved);
+        CPPUNIT_ASSERT(num_edges(assigned) == 2001);
+        CPPUNIT_ASSERT(num_edges(original) == 1);
+        CPPUNIT_ASSERT(validate(assigned));}
+
+    // -----
+    // suite
+    // -----
+
+    CPPUNIT_TEST_SUITE(TestArena);
+    CPPUNIT_TEST(test_allocate_1);
+    CPPUNIT_TEST(test_allocate_2);
+    CPPUNIT_TEST(test_arena_graph_1);
+    CPPUNIT_TEST(test_arena_graph_2);
+    CPPUNIT_TEST(test_arena_graph_3);
     CPPUNIT_TEST_SUITE_END();};
 
 
@@ -505,6 +1889,12 @@ int main () {
     CppUnit::TextTestRunner tr;
     tr.addTest(TestGraph< adjacency_list<setS, vecS, directedS> >::suite());
     tr.addTest(TestGraph<Graph>::suite());
+    tr.addTest(TestGraph< basic_graph<uint32_t> >::suite());
+    tr.addTest(TestGraph< basic_graph<int, no_edge_property, arena_allocator<int> > >::suite());
+    tr.addTest(TestGraphExtensions::suite());
+    tr.addTest(TestCsrGraph::suite());
+    tr.addTest(TestMappedGraph::suite());
+    tr.addTest(TestArena::suite());
     tr.run();
 
     cout << "Done." << endl;